@@ -0,0 +1,380 @@
+/*
+ * Compares MutablePriorityQueue<Vertex> with IndexedHeap, in isolation and inside Prim's algorithm, and a lazy binary
+ * heap (duplicates instead of decreaseKey) with IndexedHeap, as Graph::primSparse uses it, on a sparse graph
+ * Usage: HeapBenchmark [number of vertices] [repetitions]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include "indexedHeap.h"
+#include "graph.h"
+
+/**
+ * Runs a function several times
+ * @return The fastest run, in milliseconds
+ */
+static double bestOf(unsigned int repetitions, const std::function<void()> &run) {
+    double best = constants::INF;
+    for (unsigned int r = 0; r < repetitions; r++) {
+        auto start = std::chrono::high_resolution_clock::now();
+        run();
+        std::chrono::duration<double, std::milli> duration = std::chrono::high_resolution_clock::now() - start;
+        best = std::min(best, duration.count());
+    }
+    return best;
+}
+
+/**
+ * Vertex as the graph stored it before dense ids: one shared, heap-allocated object per vertex, reduced to the fields
+ * MutablePriorityQueue and Prim use
+ */
+class Vertex {
+    unsigned int id;
+    double dist = 0;
+    bool visited = false;
+    int queueIndex = 0; // slot in MutablePriorityQueue
+
+    template<class T> friend class MutablePriorityQueue;
+
+  public:
+    explicit Vertex(unsigned int id) : id(id) {}
+
+    [[nodiscard]] unsigned int getId() const { return id; }
+
+    [[nodiscard]] double getDist() const { return dist; }
+
+    void setDist(double newDist) { dist = newDist; }
+
+    [[nodiscard]] bool isVisited() const { return visited; }
+
+    void setVisited(bool newVisited) { visited = newVisited; }
+
+    bool operator<(const Vertex &rhs) const { return dist < rhs.dist; }
+};
+
+/**
+ * Mutable priority queue the project used before IndexedHeap: a binary heap of shared pointers, 1-based, where each
+ * element stores its own slot (T needs an accessible int queueIndex and operator<)
+ */
+template<class T>
+class MutablePriorityQueue {
+    std::vector<std::shared_ptr<T>> H = {nullptr};
+
+    void set(unsigned int i, std::shared_ptr<T> x) {
+        H[i] = x;
+        x->queueIndex = (int) i;
+    }
+
+    void heapifyUp(unsigned int i) {
+        auto x = H[i];
+        while (i > 1 && *x < *H[i / 2]) {
+            set(i, H[i / 2]);
+            i /= 2;
+        }
+        set(i, x);
+    }
+
+    void heapifyDown(unsigned int i) {
+        auto x = H[i];
+        while (true) {
+            unsigned int k = i * 2;
+            if (k >= H.size()) break;
+            if (k + 1 < H.size() && *H[k + 1] < *H[k]) ++k;
+            if (!(*H[k] < *x)) break;
+            set(i, H[k]);
+            i = k;
+        }
+        set(i, x);
+    }
+
+  public:
+    void insert(std::shared_ptr<T> x) {
+        H.push_back(x);
+        heapifyUp((unsigned int) H.size() - 1);
+    }
+
+    std::shared_ptr<T> extractMin() {
+        auto x = H[1];
+        H[1] = H.back();
+        H.pop_back();
+        if (H.size() > 1) heapifyDown(1);
+        x->queueIndex = 0;
+        return x;
+    }
+
+    void decreaseKey(std::shared_ptr<T> x) {
+        heapifyUp(x->queueIndex);
+    }
+
+    bool empty() {
+        return H.size() == 1;
+    }
+};
+
+/**
+ * Sequence of operations shared by every queue in the isolated benchmark:
+ * insert every id, then alternate between a few decreases and one extraction
+ */
+struct Workload {
+    std::vector<double> initialKeys;
+    std::vector<std::pair<unsigned int, double>> decreases; // (id, key decrement), D per extraction
+    static const unsigned int DECREASES_PER_EXTRACTION = 8;
+
+    explicit Workload(unsigned int n) {
+        std::mt19937 generator(42);
+        std::uniform_real_distribution<double> key(1000, 2000), decrement(0, 1);
+        std::uniform_int_distribution<unsigned int> id(0, n - 1);
+        for (unsigned int i = 0; i < n; i++) initialKeys.push_back(key(generator));
+        for (unsigned int i = 0; i < n * DECREASES_PER_EXTRACTION; i++) decreases.emplace_back(id(generator), decrement(generator));
+    }
+};
+
+static double runMutablePriorityQueue(const Workload &w) {
+    unsigned int n = w.initialKeys.size();
+    std::vector<std::shared_ptr<Vertex>> vertices;
+    MutablePriorityQueue<Vertex> q;
+    for (unsigned int i = 0; i < n; i++) {
+        vertices.push_back(std::make_shared<Vertex>(i));
+        vertices[i]->setDist(w.initialKeys[i]);
+        vertices[i]->setVisited(false);
+        q.insert(vertices[i]);
+    }
+    double checksum = 0;
+    size_t next = 0;
+    while (!q.empty()) {
+        for (unsigned int d = 0; d < Workload::DECREASES_PER_EXTRACTION; d++, next++) {
+            auto [id, decrement] = w.decreases[next];
+            if (vertices[id]->isVisited()) continue;
+            vertices[id]->setDist(vertices[id]->getDist() - decrement);
+            q.decreaseKey(vertices[id]);
+        }
+        std::shared_ptr<Vertex> min = q.extractMin();
+        min->setVisited(true);
+        checksum += min->getDist();
+    }
+    return checksum;
+}
+
+template<unsigned int D>
+static double runIndexedHeap(const Workload &w) {
+    unsigned int n = w.initialKeys.size();
+    IndexedHeap<D> q(n);
+    for (unsigned int i = 0; i < n; i++) q.insert(i, w.initialKeys[i]);
+    double checksum = 0;
+    size_t next = 0;
+    while (!q.empty()) {
+        for (unsigned int d = 0; d < Workload::DECREASES_PER_EXTRACTION; d++, next++) {
+            auto [id, decrement] = w.decreases[next];
+            if (q.contains(id)) q.decreaseKey(id, q.getKey(id) - decrement);
+        }
+        checksum += q.topKey();
+        q.extractMin();
+    }
+    return checksum;
+}
+
+/**
+ * Prim's algorithm over a dense row-major matrix, as Graph::prim did with MutablePriorityQueue<Vertex>
+ * @return Weight of the MST
+ */
+static double primMutablePriorityQueue(const std::vector<double> &matrix, unsigned int n) {
+    std::vector<std::shared_ptr<Vertex>> vertices;
+    for (unsigned int i = 0; i < n; i++) {
+        vertices.push_back(std::make_shared<Vertex>(i));
+        vertices[i]->setDist(constants::INF);
+        vertices[i]->setVisited(false);
+    }
+    MutablePriorityQueue<Vertex> q;
+    vertices[0]->setDist(0);
+    q.insert(vertices[0]);
+    double weight = 0;
+    while (!q.empty()) {
+        std::shared_ptr<Vertex> current = q.extractMin();
+        current->setVisited(true);
+        weight += current->getDist();
+        const double *row = matrix.data() + (size_t) current->getId() * n;
+        for (unsigned int i = 0; i < n; i++) {
+            if (i == current->getId() || vertices[i]->isVisited() || row[i] >= vertices[i]->getDist()) continue;
+            bool queued = vertices[i]->getDist() != constants::INF;
+            vertices[i]->setDist(row[i]);
+            queued ? q.decreaseKey(vertices[i]) : q.insert(vertices[i]);
+        }
+    }
+    return weight;
+}
+
+template<unsigned int D>
+static double primIndexedHeap(const std::vector<double> &matrix, unsigned int n) {
+    std::vector<double> dist(n, constants::INF);
+    std::vector<bool> visited(n, false);
+    IndexedHeap<D> q(n);
+    dist[0] = 0;
+    q.insert(0, 0);
+    double weight = 0;
+    while (!q.empty()) {
+        unsigned int current = q.extractMin();
+        visited[current] = true;
+        weight += dist[current];
+        const double *row = matrix.data() + (size_t) current * n;
+        for (unsigned int i = 0; i < n; i++) {
+            if (i == current || visited[i] || row[i] >= dist[i]) continue;
+            dist[i] = row[i];
+            q.insertOrDecrease(i, row[i]);
+        }
+    }
+    return weight;
+}
+
+/**
+ * Adjacency lists in CSR form: the edges of v are targets/lengths[offsets[v]..offsets[v + 1])
+ */
+struct Adjacency {
+    std::vector<unsigned int> offsets, targets;
+    std::vector<double> lengths;
+};
+
+/**
+ * Prim's algorithm over adjacency lists with a lazy binary heap: a shorter edge pushes a duplicate entry, and stale
+ * entries are skipped when popped
+ * @return Weight of the MST
+ */
+static double primLazyHeap(const Adjacency &adjacency, unsigned int n) {
+    std::vector<double> dist(n, constants::INF);
+    std::vector<bool> visited(n, false);
+    std::vector<std::pair<double, unsigned int>> q;
+    dist[0] = 0;
+    q.emplace_back(0, 0);
+    double weight = 0;
+    while (!q.empty()) {
+        std::pop_heap(q.begin(), q.end(), std::greater<>());
+        unsigned int current = q.back().second;
+        q.pop_back();
+        if (visited[current]) continue;
+        visited[current] = true;
+        weight += dist[current];
+        for (unsigned int e = adjacency.offsets[current]; e < adjacency.offsets[current + 1]; e++) {
+            unsigned int i = adjacency.targets[e];
+            if (visited[i] || adjacency.lengths[e] >= dist[i]) continue;
+            dist[i] = adjacency.lengths[e];
+            q.emplace_back(dist[i], i);
+            std::push_heap(q.begin(), q.end(), std::greater<>());
+        }
+    }
+    return weight;
+}
+
+/**
+ * Prim's algorithm over adjacency lists with an IndexedHeap, lowering keys in place, as Graph::primSparse does
+ * @return Weight of the MST
+ */
+template<unsigned int D>
+static double primIndexedHeapSparse(const Adjacency &adjacency, unsigned int n) {
+    std::vector<double> dist(n, constants::INF);
+    std::vector<bool> visited(n, false);
+    IndexedHeap<D> q(n);
+    dist[0] = 0;
+    q.insert(0, 0);
+    double weight = 0;
+    while (!q.empty()) {
+        unsigned int current = q.extractMin();
+        visited[current] = true;
+        weight += dist[current];
+        for (unsigned int e = adjacency.offsets[current]; e < adjacency.offsets[current + 1]; e++) {
+            unsigned int i = adjacency.targets[e];
+            if (visited[i] || adjacency.lengths[e] >= dist[i]) continue;
+            dist[i] = adjacency.lengths[e];
+            q.insertOrDecrease(i, dist[i]);
+        }
+    }
+    return weight;
+}
+
+int main(int argc, char **argv) {
+    unsigned int n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+    unsigned int repetitions = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5;
+
+    //Random points on a plane, as a complete graph
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<double> coordinate(0, 1000);
+    std::vector<std::pair<double, double>> points(n);
+    for (auto &p: points) p = {coordinate(generator), coordinate(generator)};
+    std::vector<double> matrix((size_t) n * n);
+    Graph graph;
+    for (unsigned int i = 0; i < n; i++) graph.addVertex(i);
+    for (unsigned int i = 0; i < n; i++)
+        for (unsigned int j = 0; j < n; j++) {
+            double length = std::hypot(points[i].first - points[j].first, points[i].second - points[j].second);
+            matrix[(size_t) i * n + j] = length;
+            if (j < i) graph.addBidirectionalEdge(i, j, length);
+        }
+
+    Workload workload(n);
+    double checksum[4];
+    printf("Isolated queue operations (%u ids, %u decreases per extraction), best of %u:\n", n,
+           Workload::DECREASES_PER_EXTRACTION, repetitions);
+    printf("  MutablePriorityQueue<Vertex>: %8.3f ms\n",
+           bestOf(repetitions, [&] { checksum[0] = runMutablePriorityQueue(workload); }));
+    printf("  IndexedHeap<2>:               %8.3f ms\n",
+           bestOf(repetitions, [&] { checksum[1] = runIndexedHeap<2>(workload); }));
+    printf("  IndexedHeap<4>:               %8.3f ms\n",
+           bestOf(repetitions, [&] { checksum[2] = runIndexedHeap<4>(workload); }));
+    printf("  IndexedHeap<8>:               %8.3f ms\n",
+           bestOf(repetitions, [&] { checksum[3] = runIndexedHeap<8>(workload); }));
+    printf("  checksums: %.3f %.3f %.3f %.3f\n\n", checksum[0], checksum[1], checksum[2], checksum[3]);
+
+    double weight[3];
+    printf("Prim's algorithm on a complete graph with %u vertices, best of %u:\n", n, repetitions);
+    printf("  MutablePriorityQueue<Vertex>: %8.3f ms\n",
+           bestOf(repetitions, [&] { weight[0] = primMutablePriorityQueue(matrix, n); }));
+    printf("  IndexedHeap<2>:               %8.3f ms\n",
+           bestOf(repetitions, [&] { weight[1] = primIndexedHeap<2>(matrix, n); }));
+    printf("  IndexedHeap<4>:               %8.3f ms\n",
+           bestOf(repetitions, [&] { weight[2] = primIndexedHeap<4>(matrix, n); }));
+    SolveContext context;
+    printf("  Graph::prim (array scan):     %8.3f ms\n", bestOf(repetitions, [&] { graph.prim(context); }));
+    printf("  MST weights: %.3f %.3f %.3f\n\n", weight[0], weight[1], weight[2]);
+
+    //Each point joined to SPARSE_DEGREE random others (and a path through all of them, so the graph is connected)
+    const unsigned int SPARSE_DEGREE = 8;
+    std::uniform_int_distribution<unsigned int> other(0, n - 1);
+    std::vector<std::vector<std::pair<unsigned int, double>>> lists(n);
+    Graph sparse;
+    for (unsigned int i = 0; i < n; i++) sparse.addVertex(i);
+    auto connect = [&](unsigned int i, unsigned int j) {
+        if (i == j) return;
+        double length = matrix[(size_t) i * n + j];
+        lists[i].emplace_back(j, length);
+        lists[j].emplace_back(i, length);
+        sparse.addBidirectionalEdge(i, j, length);
+    };
+    for (unsigned int i = 0; i + 1 < n; i++) connect(i, i + 1);
+    for (unsigned int i = 0; i < n; i++)
+        for (unsigned int d = 0; d < SPARSE_DEGREE / 2; d++) connect(i, other(generator));
+    Adjacency adjacency;
+    adjacency.offsets.push_back(0);
+    for (const auto &list: lists) {
+        for (auto [target, length]: list) {
+            adjacency.targets.push_back(target);
+            adjacency.lengths.push_back(length);
+        }
+        adjacency.offsets.push_back((unsigned int) adjacency.targets.size());
+    }
+
+    double sparseWeight[2];
+    printf("Prim's algorithm on a sparse graph with %u vertices and %zu edges, best of %u:\n", n,
+           adjacency.targets.size() / 2, repetitions);
+    printf("  lazy binary heap:             %8.3f ms\n",
+           bestOf(repetitions, [&] { sparseWeight[0] = primLazyHeap(adjacency, n); }));
+    printf("  IndexedHeap<4>:               %8.3f ms\n",
+           bestOf(repetitions, [&] { sparseWeight[1] = primIndexedHeapSparse<4>(adjacency, n); }));
+    sparse.prim(context); //Builds the adjacency lists, which are cached after the first call
+    printf("  Graph::prim (IndexedHeap<4>): %8.3f ms\n", bestOf(repetitions, [&] { sparse.prim(context); }));
+    printf("  MST weights: %.3f %.3f\n", sparseWeight[0], sparseWeight[1]);
+    return 0;
+}
@@ -0,0 +1,432 @@
+/*
+ * Runs every algorithm over every bundled dataset, with warmup runs and repetitions, and reports time, tour length
+ * and memory; the results can be saved as a baseline and later runs compared against it
+ * Each case runs in a child process of its own, so its peak memory is that of a process holding the graph and
+ * running that case only
+ * The "precision" case of each dataset checks that tour lengths computed from FLOAT and FIXED distances stay within
+ * Graph::getDistanceMaxError of the exact ones
+ * Usage: SuiteBenchmark [options] [dataset directory (default ../dataset)]
+ *   --repetitions N   timed runs per case (default 5)
+ *   --warmup N        untimed runs before them (default 1)
+ *   --time-limit MS   budget of the anytime engines, per run (default 200)
+ *   --filter TEXT     only the cases whose dataset or algorithm name contains TEXT
+ *   --save FILE       write the results as a baseline
+ *   --baseline FILE   compare against a saved baseline; exits with 2 if anything regressed
+ *   --tolerance PCT   change allowed before a case counts as a regression (default 10)
+ */
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "graph.h"
+#include "graphLoader.h"
+#include "solverHandle.h"
+
+/**
+ * Exact search is only run on graphs this small, as it grows factorially
+ */
+static const unsigned int BACKTRACKING_LIMIT = 16;
+
+/**
+ * Differences in time below this many milliseconds are noise, whatever the tolerance
+ */
+static const double TIME_NOISE_FLOOR = 1;
+
+/**
+ * Clustering is seeded by k-means++: a fixed seed makes its tours repeatable, so they can be compared exactly
+ */
+static const Graph::cluster_t CLUSTERING_OPTIONS = {.seed = 1};
+
+struct Dataset {
+    std::string name, edgesFile, nodesFile; // files relative to the dataset directory
+};
+
+struct Algorithm {
+    std::string name;
+    bool anytime;      // runs until its time limit, so only the length it reaches is compared
+    bool coordinates;  // needs the coordinates of the stops
+    std::function<double(const Graph &, std::chrono::milliseconds)> run; // returns the length of the tour found
+};
+
+/**
+ * Timings and lengths of one algorithm on one dataset
+ */
+struct Measurement {
+    std::string dataset, algorithm;
+    unsigned int stops = 0;
+    bool anytime = false;
+    double medianMilliseconds = 0, minMilliseconds = 0, meanMilliseconds = 0, stddevMilliseconds = 0;
+    double bestLength = constants::INF, meanLength = constants::INF;
+    long peakMemoryKilobytes = 0; // of the process running the case alone, graph included
+};
+
+static const Dataset DATASETS[] = {
+        {"shipping", "Toy-Graphs/shipping.csv", ""},
+        {"stadiums", "Toy-Graphs/stadiums.csv", ""},
+        {"tourism",  "Toy-Graphs/tourism.csv",  ""},
+        {"edges_25",  "Extra_Fully_Connected_Graphs/edges_25.csv",  ""},
+        {"edges_50",  "Extra_Fully_Connected_Graphs/edges_50.csv",  ""},
+        {"edges_75",  "Extra_Fully_Connected_Graphs/edges_75.csv",  ""},
+        {"edges_100", "Extra_Fully_Connected_Graphs/edges_100.csv", ""},
+        {"edges_200", "Extra_Fully_Connected_Graphs/edges_200.csv", ""},
+        {"edges_300", "Extra_Fully_Connected_Graphs/edges_300.csv", ""},
+        {"edges_400", "Extra_Fully_Connected_Graphs/edges_400.csv", ""},
+        {"edges_500", "Extra_Fully_Connected_Graphs/edges_500.csv", ""},
+        {"edges_600", "Extra_Fully_Connected_Graphs/edges_600.csv", ""},
+        {"edges_700", "Extra_Fully_Connected_Graphs/edges_700.csv", ""},
+        {"edges_800", "Extra_Fully_Connected_Graphs/edges_800.csv", ""},
+        {"edges_900", "Extra_Fully_Connected_Graphs/edges_900.csv", ""},
+        {"graph1", "Real-world-Graphs/graph1/edges.csv", "Real-world-Graphs/graph1/nodes.csv"},
+        {"graph2", "Real-world-Graphs/graph2/edges.csv", "Real-world-Graphs/graph2/nodes.csv"},
+        {"graph3", "Real-world-Graphs/graph3/edges.csv", "Real-world-Graphs/graph3/nodes.csv"},
+};
+
+/**
+ * Runs an engine through an incumbent with the given time budget
+ * @return Length of the best tour it found
+ */
+static double solveFor(const Graph &graph, SolverHandle::Engine engine, std::chrono::milliseconds budget) {
+    Incumbent incumbent(std::chrono::steady_clock::now() + budget);
+    SolverHandle::solve(graph, engine, incumbent);
+    return incumbent.getLength();
+}
+
+/**
+ * The classical algorithms are called directly, so they are timed to completion; the anytime engines get the same
+ * budget on every dataset
+ */
+static const Algorithm ALGORITHMS[] = {
+        {"backtracking",      false, false, [](const Graph &g, auto) { return g.tspBT().getLength(); }},
+        {"triangular",        false, false, [](const Graph &g, auto) { return g.triangularTSPTour().getLength(); }},
+        {"nearest-insertion", false, false,
+                [](const Graph &g, auto) { return g.nearestInsertionHeuristic(0).getLength(); }},
+        {"clustering",        false, true,  [](const Graph &g, auto) { return g.clusteredTSPTour(CLUSTERING_OPTIONS).getLength(); }},
+        {"annealing",         true,  false,
+                [](const Graph &g, auto budget) {
+                    return solveFor(g, SolverHandle::Engine::SIMULATED_ANNEALING, budget);
+                }},
+        {"genetic",           true,  false,
+                [](const Graph &g, auto budget) {
+                    return solveFor(g, SolverHandle::Engine::GENETIC_ALGORITHM, budget);
+                }},
+        {"ant-colony",        true,  false,
+                [](const Graph &g, auto budget) { return solveFor(g, SolverHandle::Engine::ANT_COLONY, budget); }},
+        {"portfolio",         true,  false,
+                [](const Graph &g, auto budget) { return solveFor(g, SolverHandle::Engine::PORTFOLIO, budget); }},
+};
+
+static long peakMemoryKilobytes() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/**
+ * Runs an algorithm on a loaded graph, discarding the warmup runs
+ * @return Statistics of the timed runs (time in milliseconds, tour lengths)
+ */
+static Measurement measure(const Graph &graph, const Algorithm &algorithm, unsigned int warmup,
+                           unsigned int repetitions, std::chrono::milliseconds budget) {
+    Measurement m;
+    m.algorithm = algorithm.name;
+    m.anytime = algorithm.anytime;
+    m.stops = graph.getNumVertex();
+    for (unsigned int r = 0; r < warmup; r++) algorithm.run(graph, budget);
+
+    std::vector<double> times;
+    double lengthSum = 0;
+    for (unsigned int r = 0; r < repetitions; r++) {
+        auto start = std::chrono::high_resolution_clock::now();
+        double length = algorithm.run(graph, budget);
+        std::chrono::duration<double, std::milli> duration = std::chrono::high_resolution_clock::now() - start;
+        times.push_back(duration.count());
+        m.bestLength = std::min(m.bestLength, length);
+        lengthSum += length;
+    }
+    std::sort(times.begin(), times.end());
+    size_t middle = times.size() / 2;
+    m.medianMilliseconds = times.size() % 2 ? times[middle] : (times[middle - 1] + times[middle]) / 2;
+    m.minMilliseconds = times.front();
+    for (double t: times) m.meanMilliseconds += t / (double) times.size();
+    for (double t: times) m.stddevMilliseconds += (t - m.meanMilliseconds) * (t - m.meanMilliseconds);
+    m.stddevMilliseconds = times.size() > 1 ? std::sqrt(m.stddevMilliseconds / (double) (times.size() - 1)) : 0;
+    m.meanLength = lengthSum / repetitions;
+    m.peakMemoryKilobytes = peakMemoryKilobytes();
+    return m;
+}
+
+/**
+ * Runs measure in a child process, whose peak memory counts the graph it inherits and what the case allocates, but
+ * not what earlier cases did (the peak of a process never decreases)
+ * @return The statistics of the timed runs, or none if the child couldn't be started or failed
+ */
+static std::optional<Measurement> measureIsolated(const Graph &graph, const Algorithm &algorithm, unsigned int warmup,
+                                                  unsigned int repetitions, std::chrono::milliseconds budget) {
+    int channel[2];
+    if (pipe(channel) != 0) return std::nullopt;
+    fflush(stdout);
+    pid_t child = fork();
+    if (child < 0) {
+        close(channel[0]);
+        close(channel[1]);
+        return std::nullopt;
+    }
+    if (child == 0) {
+        close(channel[0]);
+        Measurement m = measure(graph, algorithm, warmup, repetitions, budget);
+        double values[] = {m.medianMilliseconds, m.minMilliseconds, m.meanMilliseconds, m.stddevMilliseconds,
+                           m.bestLength, m.meanLength, (double) m.peakMemoryKilobytes};
+        bool sent = write(channel[1], values, sizeof values) == (ssize_t) sizeof values;
+        _exit(sent ? 0 : 1);
+    }
+    close(channel[1]);
+    double values[7];
+    bool received = read(channel[0], values, sizeof values) == (ssize_t) sizeof values;
+    close(channel[0]);
+    int status = 0;
+    waitpid(child, &status, 0);
+    if (!received || !WIFEXITED(status) || WEXITSTATUS(status) != 0) return std::nullopt;
+
+    Measurement m;
+    m.algorithm = algorithm.name;
+    m.anytime = algorithm.anytime;
+    m.stops = graph.getNumVertex();
+    double *fields[] = {&m.medianMilliseconds, &m.minMilliseconds, &m.meanMilliseconds, &m.stddevMilliseconds,
+                        &m.bestLength, &m.meanLength};
+    for (unsigned int f = 0; f < 6; f++) *fields[f] = values[f];
+    m.peakMemoryKilobytes = (long) values[6];
+    return m;
+}
+
+/**
+ * Copies the distances of a graph into one storing them at a lower precision, solves it by nearest insertion and
+ * measures the tour again over the exact distances, checking that the two lengths differ by at most the error bound
+ * the lower precision reports
+ * Time Complexity: O(|V|²)
+ * @return true if the difference is within the bound
+ */
+static bool checkPrecision(const Graph &graph, DistanceMatrix::Precision precision, const char *name) {
+    unsigned int n = graph.getNumVertex();
+    Graph reduced;
+    reduced.setDistanceStorage(DistanceMatrix::Layout::PACKED, precision);
+    for (unsigned int v = 0; v < n; v++) reduced.addVertex(graph.getExternalId(v), graph.getCoordinates(v));
+    for (unsigned int i = 0; i < n; i++)
+        for (unsigned int j = 0; j < i; j++) {
+            double length = graph.findEdge(i, j);
+            if (length >= 0 && length != constants::INF) reduced.addBidirectionalEdge(i, j, length);
+        }
+
+    Tour tour = reduced.nearestInsertionHeuristic(0);
+    if (tour.empty()) return true;
+    double stored = tour.getLength();
+    double exact = tour.computeLength([&graph](unsigned int a, unsigned int b) { return graph.findEdge(a, b); });
+    double bound = reduced.getDistanceMaxError(stored, tour.size());
+    //Sums of doubles in a different order may differ by a few ulps, which no precision accounts for
+    bool within = std::abs(stored - exact) <= bound + exact * 1e-12;
+    printf("  %-18s length %14.4f  exact %14.4f  error %10.6f  bound %10.6f%s\n", name, stored, exact,
+           std::abs(stored - exact), bound, within ? "" : " (exceeded)");
+    return within;
+}
+
+/**
+ * Reads a whole argument as a number, as the command line does
+ * @return false if the argument isn't a number, has trailing characters or is out of range
+ */
+template<typename T>
+static bool parseNumber(const char *text, T &value) {
+    const char *end = text + strlen(text);
+    auto [last, error] = std::from_chars(text, end, value);
+    return error == std::errc() && last == end;
+}
+
+/**
+ * Reads a baseline written by saveBaseline
+ * @return Measurements by "dataset/algorithm", empty if the file can't be read
+ */
+static std::map<std::string, Measurement> readBaseline(const std::string &filename) {
+    std::map<std::string, Measurement> baseline;
+    std::ifstream file(filename);
+    std::string line;
+    std::getline(file, line); //Header
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        Measurement m;
+        std::string anytime, field;
+        std::getline(fields, m.dataset, ',');
+        std::getline(fields, m.algorithm, ',');
+        std::getline(fields, anytime, ',');
+        m.anytime = anytime == "1";
+        double *values[] = {&m.medianMilliseconds, &m.minMilliseconds, &m.meanMilliseconds, &m.stddevMilliseconds,
+                            &m.bestLength, &m.meanLength};
+        bool valid = (bool) (fields >> m.stops);
+        for (double *value: values) valid = valid && fields.get() == ',' && (fields >> *value);
+        valid = valid && fields.get() == ',' && (fields >> m.peakMemoryKilobytes);
+        if (valid) baseline[m.dataset + "/" + m.algorithm] = m;
+    }
+    return baseline;
+}
+
+static bool saveBaseline(const std::string &filename, const std::vector<Measurement> &results) {
+    FILE *file = fopen(filename.c_str(), "w");
+    if (file == nullptr) return false;
+    fprintf(file, "dataset,algorithm,anytime,stops,median_ms,min_ms,mean_ms,stddev_ms,best_length,mean_length,"
+                  "peak_memory_kb\n");
+    for (const Measurement &m: results)
+        fprintf(file, "%s,%s,%d,%u,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%ld\n", m.dataset.c_str(), m.algorithm.c_str(),
+                m.anytime ? 1 : 0, m.stops, m.medianMilliseconds, m.minMilliseconds, m.meanMilliseconds,
+                m.stddevMilliseconds, m.bestLength, m.meanLength, m.peakMemoryKilobytes);
+    return fclose(file) == 0;
+}
+
+/**
+ * Prints how a measurement changed since the baseline: time (for the algorithms that run to completion) and the
+ * mean tour length
+ * @return true if either got worse by more than the tolerance
+ */
+static bool compare(const Measurement &m, const Measurement &base, double tolerance) {
+    bool regressed = false;
+    if (!m.anytime) {
+        double change = 100 * (m.medianMilliseconds / base.medianMilliseconds - 1);
+        bool slower = change > tolerance && m.medianMilliseconds - base.medianMilliseconds > TIME_NOISE_FLOOR;
+        printf("  time %+7.1f%%%s", change, slower ? " (slower)" : "");
+        regressed = slower;
+    }
+    double change = 100 * (m.meanLength / base.meanLength - 1);
+    bool longer = m.anytime ? change > tolerance / 10 : change > 1e-6; //Deterministic tours shouldn't change at all
+    printf("  length %+7.3f%%%s", change, longer ? " (longer)" : "");
+    return regressed || longer;
+}
+
+int main(int argc, char **argv) {
+    std::string directory = "../dataset", filter, saveFile, baselineFile;
+    unsigned int repetitions = 5, warmup = 1;
+    std::chrono::milliseconds budget(200);
+    double tolerance = 10;
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (option.rfind("--", 0) != 0) {
+            directory = option;
+            continue;
+        }
+        if (i + 1 == argc) {
+            fprintf(stderr, "Missing value for %s\n", option.c_str());
+            return 1;
+        }
+        const char *value = argv[++i];
+        unsigned int milliseconds;
+        bool valid = true;
+        if (option == "--repetitions") valid = parseNumber(value, repetitions) && repetitions > 0;
+        else if (option == "--warmup") valid = parseNumber(value, warmup);
+        else if (option == "--time-limit") {
+            valid = parseNumber(value, milliseconds);
+            budget = std::chrono::milliseconds(milliseconds);
+        } else if (option == "--filter") filter = value;
+        else if (option == "--save") saveFile = value;
+        else if (option == "--baseline") baselineFile = value;
+        else if (option == "--tolerance") valid = parseNumber(value, tolerance) && tolerance >= 0;
+        else {
+            fprintf(stderr, "Unknown option %s\n", option.c_str());
+            return 1;
+        }
+        if (!valid) {
+            fprintf(stderr, "Invalid argument %s %s\n", option.c_str(), value);
+            return 1;
+        }
+    }
+
+    std::map<std::string, Measurement> baseline;
+    if (!baselineFile.empty()) {
+        baseline = readBaseline(baselineFile);
+        if (baseline.empty()) {
+            fprintf(stderr, "Couldn't read the baseline %s\n", baselineFile.c_str());
+            return 1;
+        }
+    }
+
+    printf("%u warmup and %u timed runs per case, anytime engines stopped after %lld ms\n\n", warmup, repetitions,
+           (long long) budget.count());
+    std::vector<Measurement> results;
+    unsigned int regressions = 0;
+    for (const Dataset &dataset: DATASETS) {
+        std::vector<const Algorithm *> selected;
+        for (const Algorithm &algorithm: ALGORITHMS)
+            if (filter.empty() || dataset.name.find(filter) != std::string::npos ||
+                algorithm.name.find(filter) != std::string::npos)
+                selected.push_back(&algorithm);
+        bool precision = filter.empty() || dataset.name.find(filter) != std::string::npos ||
+                         std::string("precision").find(filter) != std::string::npos;
+        if (selected.empty() && !precision) continue;
+
+        std::string edges = directory + "/" + dataset.edgesFile;
+        std::string nodes = dataset.nodesFile.empty() ? "" : directory + "/" + dataset.nodesFile;
+        if (!std::filesystem::exists(edges)) {
+            printf("%s: %s not found, skipped\n\n", dataset.name.c_str(), edges.c_str());
+            continue;
+        }
+        Graph graph;
+        auto start = std::chrono::high_resolution_clock::now();
+        if (!GraphLoader::load(graph, edges, nodes)) {
+            printf("%s: couldn't be loaded, skipped\n\n", dataset.name.c_str());
+            continue;
+        }
+        bool closed = !graph.isComplete();
+        if (closed) graph.buildMetricClosure(); //So every algorithm finds a tour
+        graph.buildCandidateLists(Graph::CANDIDATE_LIST_SIZE);
+        std::chrono::duration<double, std::milli> loading = std::chrono::high_resolution_clock::now() - start;
+        printf("%s: %u stops, loaded%s in %.1f ms, distances take %.1f KiB\n", dataset.name.c_str(),
+               graph.getNumVertex(), closed ? " and closed" : "", loading.count(),
+               (double) graph.getDistanceMemoryUsage() / 1024);
+
+        for (const Algorithm *algorithm: selected) {
+            if (algorithm->name == "backtracking" && graph.getNumVertex() > BACKTRACKING_LIMIT) continue;
+            if (algorithm->coordinates && nodes.empty()) continue;
+            std::optional<Measurement> measured = measureIsolated(graph, *algorithm, warmup, repetitions, budget);
+            if (!measured) {
+                printf("  %-18s failed\n", algorithm->name.c_str());
+                continue;
+            }
+            Measurement &m = *measured;
+            m.dataset = dataset.name;
+            printf("  %-18s median %10.3f ms  min %10.3f  mean %10.3f  sd %8.3f  length %14.2f  peak %7ld KiB\n",
+                   m.algorithm.c_str(), m.medianMilliseconds, m.minMilliseconds, m.meanMilliseconds,
+                   m.stddevMilliseconds, m.meanLength, m.peakMemoryKilobytes);
+            auto base = baseline.find(m.dataset + "/" + m.algorithm);
+            if (base != baseline.end()) {
+                printf("  %-18s", "");
+                if (compare(m, base->second, tolerance)) regressions++;
+                printf("\n");
+            }
+            results.push_back(m);
+        }
+        if (precision) {
+            if (!checkPrecision(graph, DistanceMatrix::Precision::FLOAT, "precision float")) regressions++;
+            if (!checkPrecision(graph, DistanceMatrix::Precision::FIXED, "precision fixed")) regressions++;
+        }
+        printf("\n");
+    }
+
+    if (!saveFile.empty()) {
+        if (!saveBaseline(saveFile, results)) {
+            fprintf(stderr, "Couldn't write %s\n", saveFile.c_str());
+            return 1;
+        }
+        printf("Saved %zu results to %s\n", results.size(), saveFile.c_str());
+    }
+    if (!baselineFile.empty()) printf("%u regressions against %s\n", regressions, baselineFile.c_str());
+    else if (regressions != 0) printf("%u precision checks failed\n", regressions);
+    return regressions == 0 ? 0 : 2;
+}
@@ -0,0 +1,120 @@
+/*
+ * Compares the recursive UFDS the project used to have, the iterative UFDS and ConcurrentUFDS on 1 and more threads
+ * Usage: UFDSBenchmark [number of elements] [repetitions] [threads]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include <functional>
+#include "UFDS.h"
+#include "concurrentUFDS.h"
+#include "parallel.h"
+#include "constants.h"
+
+/**
+ * Runs a function several times
+ * @return The fastest run, in milliseconds
+ */
+static double bestOf(unsigned int repetitions, const std::function<void()> &run) {
+    double best = constants::INF;
+    for (unsigned int r = 0; r < repetitions; r++) {
+        auto start = std::chrono::high_resolution_clock::now();
+        run();
+        std::chrono::duration<double, std::milli> duration = std::chrono::high_resolution_clock::now() - start;
+        best = std::min(best, duration.count());
+    }
+    return best;
+}
+
+/**
+ * UFDS as it was before findSet became iterative: recursive, with full path compression
+ */
+class RecursiveUFDS {
+    std::vector<unsigned int> path, rank;
+
+  public:
+    explicit RecursiveUFDS(unsigned int n) : path(n), rank(n, 0) {
+        for (unsigned int i = 0; i < n; i++) path[i] = i;
+    }
+
+    unsigned long findSet(unsigned int i) {
+        if (path[i] != i) path[i] = findSet(path[i]);
+        return path[i];
+    }
+
+    bool isSameSet(unsigned int i, unsigned int j) {
+        return findSet(i) == findSet(j);
+    }
+
+    void linkSets(unsigned int i, unsigned int j) {
+        if (!isSameSet(i, j)) {
+            unsigned long x = findSet(i), y = findSet(j);
+            if (rank[x] > rank[y]) path[y] = x;
+            else {
+                path[x] = y;
+                if (rank[x] == rank[y]) rank[y]++;
+            }
+        }
+    }
+};
+
+/**
+ * Kruskal-like sequence of operations: check whether two random elements are already connected and link them if not
+ */
+static std::vector<std::pair<unsigned int, unsigned int>> makeOperations(unsigned int n, unsigned int count) {
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<unsigned int> element(0, n - 1);
+    std::vector<std::pair<unsigned int, unsigned int>> operations(count);
+    for (auto &op: operations) op = {element(generator), element(generator)};
+    return operations;
+}
+
+template<typename Sets>
+static unsigned int runSequential(unsigned int n, const std::vector<std::pair<unsigned int, unsigned int>> &ops) {
+    Sets sets(n);
+    unsigned int links = 0;
+    for (auto [i, j]: ops) {
+        if (sets.isSameSet(i, j)) continue;
+        sets.linkSets(i, j);
+        links++;
+    }
+    return links;
+}
+
+static unsigned int runConcurrent(unsigned int n, const std::vector<std::pair<unsigned int, unsigned int>> &ops,
+                                  unsigned int threads) {
+    ConcurrentUFDS sets(n);
+    std::vector<unsigned int> links(parallel::threadCount(threads), 0);
+    parallel::forBlocks((unsigned int) ops.size(), threads, [&](unsigned int first, unsigned int last, unsigned int t) {
+        unsigned int count = 0;
+        for (unsigned int k = first; k < last; k++)
+            if (!sets.isSameSet(ops[k].first, ops[k].second) && sets.linkSets(ops[k].first, ops[k].second)) count++;
+        links[t] = count;
+    });
+    unsigned int total = 0;
+    for (unsigned int count: links) total += count;
+    return total;
+}
+
+int main(int argc, char **argv) {
+    unsigned int n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    unsigned int repetitions = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5;
+    unsigned int threads = parallel::threadCount(argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 0);
+
+    auto operations = makeOperations(n, n * 4);
+    unsigned int links[4];
+    printf("%zu connectivity checks and links on %u elements, best of %u:\n", operations.size(), n, repetitions);
+    printf("  UFDS (recursive, full compression): %8.3f ms\n",
+           bestOf(repetitions, [&] { links[0] = runSequential<RecursiveUFDS>(n, operations); }));
+    printf("  UFDS (iterative, path halving):     %8.3f ms\n",
+           bestOf(repetitions, [&] { links[1] = runSequential<UFDS>(n, operations); }));
+    printf("  ConcurrentUFDS, 1 thread:           %8.3f ms\n",
+           bestOf(repetitions, [&] { links[2] = runConcurrent(n, operations, 1); }));
+    printf("  ConcurrentUFDS, %2u threads:         %8.3f ms\n", threads,
+           bestOf(repetitions, [&] { links[3] = runConcurrent(n, operations, threads); }));
+    printf("  links: %u %u %u %u\n", links[0], links[1], links[2], links[3]);
+    return 0;
+}
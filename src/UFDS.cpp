@@ -11,15 +11,18 @@
 UFDS::UFDS(unsigned int N) {
     path.resize(N);
     rank.resize(N);
-    for (unsigned long i = 0; i < N; i++) {
+    for (unsigned int i = 0; i < N; i++) {
         path[i] = i;
         rank[i] = 0;
     }
 }
 
-unsigned long UFDS::findSet(unsigned int i) {
-    if (path[i] != i) path[i] = findSet(path[i]);
-    return path[i];
+unsigned int UFDS::findSet(unsigned int i) {
+    while (path[i] != i) {
+        path[i] = path[path[i]]; // Path halving: every node visited skips to its grandparent
+        i = path[i];
+    }
+    return i;
 }
 
 bool UFDS::isSameSet(unsigned int i, unsigned int j) {
@@ -27,12 +30,12 @@ bool UFDS::isSameSet(unsigned int i, unsigned int j) {
 }
 
 void UFDS::linkSets(unsigned int i, unsigned int j) {
-    if (!isSameSet(i, j)) {
-        unsigned long x = findSet(i), y = findSet(j);
+    unsigned int x = findSet(i), y = findSet(j);
+    if (x != y) {
         if (rank[x] > rank[y]) path[y] = x; // x becomes the root due to having a larger rank
         else {
             path[x] = y; // y becomes the root due to having a larger rank, or ...
             if (rank[x] == rank[y]) rank[y]++; // ... due to both nodes having the same rank (in order to break the tie)
         }
     }
-}
\ No newline at end of file
+}
@@ -14,7 +14,7 @@
 class UFDS {
 public:
     UFDS(unsigned int N);
-    unsigned long findSet(unsigned int i);
+    unsigned int findSet(unsigned int i);
     bool isSameSet(unsigned int i, unsigned int j);
     void linkSets(unsigned int i, unsigned int j);
 private:
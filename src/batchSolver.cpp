@@ -0,0 +1,150 @@
+#include "batchSolver.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include "graphLoader.h"
+#include "parallel.h"
+
+/**
+ * @param options - Engine and budget used on every instance, number of workers, memory limit and closure
+ * @param onResult - Function called with the result of every instance as soon as it is solved, from the worker that
+ * solved it (never by two workers at once)
+ */
+BatchSolver::BatchSolver(Options options, Callback onResult) : options(std::move(options)),
+                                                               onResult(std::move(onResult)) {}
+
+/**
+ * Reads a manifest: one instance per line, as the path of its edges file optionally followed by a comma and the path
+ * of its nodes file
+ * Blank lines and lines starting with '#' are skipped, and relative paths are taken from the manifest's directory
+ * Time Complexity: O(n), where n is the number of lines of the manifest
+ * @param filename - Path of the manifest
+ * @param instances - Receives the instances, in the order they are listed
+ * @return false if the manifest couldn't be opened
+ */
+bool BatchSolver::readManifest(const std::string &filename, std::vector<Instance> &instances) {
+    std::ifstream manifest(filename);
+    if (!manifest.is_open()) return false;
+    std::filesystem::path directory = std::filesystem::path(filename).parent_path();
+    auto trim = [](const std::string &text) {
+        size_t first = text.find_first_not_of(" \t\r"), last = text.find_last_not_of(" \t\r");
+        return first == std::string::npos ? std::string() : text.substr(first, last - first + 1);
+    };
+    auto resolve = [&directory](const std::string &path) {
+        if (path.empty() || std::filesystem::path(path).is_absolute()) return path;
+        return (directory / path).string();
+    };
+    std::string line;
+    while (std::getline(manifest, line)) {
+        line = trim(line);
+        if (line.empty() || line.front() == '#') continue;
+        size_t comma = line.find(',');
+        if (comma == std::string::npos) instances.push_back({resolve(line), ""});
+        else instances.push_back({resolve(trim(line.substr(0, comma))), resolve(trim(line.substr(comma + 1)))});
+    }
+    return true;
+}
+
+/**
+ * Loads and solves a single instance, waiting first for memory to be released if the limit is reached
+ * Time Complexity: that of loading the instance and of the engine
+ * @param index - Position of the instance in the manifest
+ * @param instance - Files of the instance
+ * @return The result of the instance
+ */
+BatchSolver::Result BatchSolver::solve(size_t index, const Instance &instance) {
+    Result result;
+    result.index = index;
+    result.instance = instance;
+    //With a limit, instances are loaded one at a time, each once the ones already loaded fit in the limit
+    if (options.memoryLimit != 0) {
+        std::unique_lock<std::mutex> lock(memoryMutex);
+        memoryReleased.wait(lock, [this] { return !loading && memoryInUse < options.memoryLimit; });
+        loading = true;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    Graph graph;
+    graph.setThreadCount(options.solverThreads);
+    result.loaded = GraphLoader::load(graph, instance.edgesFile, instance.nodesFile);
+    if (result.loaded && options.metricClosure && !graph.isComplete()) graph.buildMetricClosure();
+    graph.buildCandidateLists(Graph::CANDIDATE_LIST_SIZE);
+    //Converted once complete, so every stored length is rounded once, from its exact value
+    graph.setDistanceStorage(options.layout, options.precision, options.scale, options.storageDirectory);
+    size_t memory = graph.getDistanceMemoryUsage();
+    {
+        std::lock_guard<std::mutex> lock(memoryMutex);
+        memoryInUse += memory;
+        peakMemory = std::max(peakMemory, memoryInUse);
+        loading = false;
+    }
+    memoryReleased.notify_all();
+    auto loaded = std::chrono::steady_clock::now();
+    result.loadMilliseconds = std::chrono::duration<double, std::milli>(loaded - start).count();
+
+    if (result.loaded && graph.getNumVertex() != 0) {
+        Incumbent incumbent(options.budget.time == std::chrono::milliseconds::max()
+                            ? std::chrono::steady_clock::time_point::max()
+                            : loaded + options.budget.time, options.budget.iterations);
+        Graph::colony_t colony;
+        if (options.onColonyIteration)
+            colony.onIteration = [&](const Graph::colony_iteration_t &stats) {
+                options.onColonyIteration(index, stats);
+            };
+        SolverHandle::solve(graph, options.engine, incumbent, colony);
+        Improvement best = incumbent.getBest();
+        result.stops = graph.getNumVertex();
+        for (unsigned int stop: best.tour) result.route.push_back(graph.getExternalId(stop));
+        result.length = best.tour.empty() ? constants::INF : best.tour.getLength();
+        if (!best.tour.empty()) result.maxError = graph.getDistanceMaxError(result.length, best.tour.size());
+        result.engine = best.engine;
+        result.optimal = incumbent.isOptimal();
+    }
+    auto solved = std::chrono::steady_clock::now();
+    result.solveMilliseconds = std::chrono::duration<double, std::milli>(solved - loaded).count();
+
+    {
+        std::lock_guard<std::mutex> lock(memoryMutex);
+        memoryInUse -= memory;
+    }
+    memoryReleased.notify_all();
+    return result;
+}
+
+/**
+ * Solves every instance, each worker taking the next unsolved one until none is left
+ * Time Complexity: O(sum of the instances' load and solve times / workers)
+ * @param instances - Instances to solve
+ * @return How many instances were solved or failed to load, how long it took and the throughput
+ */
+BatchSolver::Summary BatchSolver::run(const std::vector<Instance> &instances) {
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<size_t> next = 0, failed = 0;
+    peakMemory = 0;
+    auto work = [&] {
+        for (size_t i = next++; i < instances.size(); i = next++) {
+            Result result = solve(i, instances[i]);
+            if (!result.loaded) failed++;
+            if (onResult) {
+                std::lock_guard<std::mutex> lock(resultMutex);
+                onResult(result);
+            }
+        }
+    };
+    auto count = (unsigned int) std::max<size_t>(instances.size(), 1);
+    unsigned int workers = std::min(parallel::threadCount(options.workers), count);
+    {
+        std::vector<std::jthread> pool;
+        for (unsigned int w = 1; w < workers; w++) pool.emplace_back(work);
+        work();
+    }
+
+    Summary summary;
+    summary.failed = failed;
+    summary.solved = instances.size() - summary.failed;
+    summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    summary.instancesPerSecond = summary.seconds > 0 ? (double) instances.size() / summary.seconds : 0;
+    summary.peakMemory = peakMemory;
+    return summary;
+}
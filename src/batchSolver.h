@@ -0,0 +1,91 @@
+#ifndef TRAVELLINGSALESMAN_BATCHSOLVER_H
+#define TRAVELLINGSALESMAN_BATCHSOLVER_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "graph.h"
+#include "solverHandle.h"
+
+/**
+ * Solves many independent instances, listed in a manifest, on a pool of worker threads
+ * Each worker takes the next instance, loads it into a Graph of its own, solves it with one engine and hands the
+ * result to a callback as soon as it is done, so results stream out in the order they finish and only the instances
+ * being solved are held in memory
+ * With a memory limit, a worker waits to load another instance while the loaded ones already use more than the limit,
+ * so at most the limit plus one instance is loaded at once
+ * The limit only counts distance storage (Graph::getDistanceMemoryUsage), the O(|V|^2) part of a loaded instance:
+ * adjacency lists and the state of the solvers (the pheromone matrix of the colony, the population of the genetic
+ * algorithm...) come on top of it
+ */
+class BatchSolver {
+  public:
+    struct Instance {
+        std::string edgesFile;
+        std::string nodesFile; // empty if the instance has no coordinates
+    };
+
+    struct Result {
+        size_t index = 0; // position of the instance in the manifest
+        Instance instance;
+        bool loaded = false; // false if a file of the instance couldn't be opened
+        unsigned int stops = 0;
+        std::vector<unsigned int> route; // dataset ids of the stops, in the order of the tour
+        double length = constants::INF;
+        double maxError = 0; // how far length can be from the exact length of the tour, with FLOAT or FIXED storage
+        std::string engine; // solver that found the tour
+        bool optimal = false;
+        double loadMilliseconds = 0;
+        double solveMilliseconds = 0;
+    };
+
+    using IterationCallback = std::function<void(size_t index, const Graph::colony_iteration_t &)>;
+
+    struct Options {
+        SolverHandle::Engine engine = SolverHandle::Engine::NEAREST_INSERTION;
+        SolverHandle::Budget budget;    // per instance
+        unsigned int workers = 0;       // instances solved at once (0 for one per hardware thread)
+        unsigned int solverThreads = 1; // threads the solvers of each instance may use
+        size_t memoryLimit = 0;         // bytes of distance storage loaded at once, solver state excluded (0 for none)
+        bool metricClosure = true;      // whether incomplete instances are completed with shortest paths
+        DistanceMatrix::Layout layout = DistanceMatrix::Layout::PACKED; // storage of the distances once loaded
+        DistanceMatrix::Precision precision = DistanceMatrix::Precision::DOUBLE;
+        double scale = 100;                 // FIXED only: lengths are stored as round(length * scale)
+        std::string storageDirectory;       // directory of the memory-mapped file holding them (empty for RAM)
+        IterationCallback onColonyIteration; // called with the index of the instance after every ant colony iteration
+    };
+
+    struct Summary {
+        size_t solved = 0;
+        size_t failed = 0; // instances that couldn't be loaded
+        double seconds = 0;
+        double instancesPerSecond = 0;
+        size_t peakMemory = 0; // most bytes of distance storage loaded at once
+    };
+
+    using Callback = std::function<void(const Result &)>;
+
+  private:
+    Options options;
+    Callback onResult;
+    std::mutex memoryMutex;
+    std::condition_variable memoryReleased;
+    size_t memoryInUse = 0;
+    bool loading = false; // whether a worker is loading an instance (only with a memory limit)
+    size_t peakMemory = 0;
+    std::mutex resultMutex; // results are handed to the callback one at a time
+
+    Result solve(size_t index, const Instance &instance);
+
+  public:
+    BatchSolver(Options options, Callback onResult);
+
+    static bool readManifest(const std::string &filename, std::vector<Instance> &instances);
+
+    Summary run(const std::vector<Instance> &instances);
+};
+
+
+#endif //TRAVELLINGSALESMAN_BATCHSOLVER_H
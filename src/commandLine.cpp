@@ -0,0 +1,262 @@
+#include "commandLine.h"
+#include <charconv>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <sys/resource.h>
+#include "parallel.h"
+#include "instrumentation.h"
+
+/**
+ * Engines that can be chosen with --algorithm, by name
+ */
+static const std::pair<const char *, SolverHandle::Engine> ALGORITHMS[] = {
+        {"backtracking",      SolverHandle::Engine::BACKTRACKING},
+        {"triangular",        SolverHandle::Engine::TRIANGULAR_APPROXIMATION},
+        {"nearest-insertion", SolverHandle::Engine::NEAREST_INSERTION},
+        {"annealing",         SolverHandle::Engine::SIMULATED_ANNEALING},
+        {"genetic",           SolverHandle::Engine::GENETIC_ALGORITHM},
+        {"ant-colony",        SolverHandle::Engine::ANT_COLONY},
+        {"clustering",        SolverHandle::Engine::CLUSTERING},
+        {"portfolio",         SolverHandle::Engine::PORTFOLIO},
+};
+
+/**
+ * Distance storage layouts and precisions that can be chosen with --layout and --precision, by name
+ */
+static const std::pair<const char *, DistanceMatrix::Layout> LAYOUTS[] = {
+        {"packed", DistanceMatrix::Layout::PACKED},
+        {"full",   DistanceMatrix::Layout::FULL},
+        {"tiled",  DistanceMatrix::Layout::TILED},
+};
+
+static const std::pair<const char *, DistanceMatrix::Precision> PRECISIONS[] = {
+        {"double", DistanceMatrix::Precision::DOUBLE},
+        {"float",  DistanceMatrix::Precision::FLOAT},
+        {"fixed",  DistanceMatrix::Precision::FIXED},
+};
+
+/**
+ * Finds a name in one of the tables above
+ * @return false if it isn't there
+ */
+template<typename T, size_t N>
+static bool lookup(const std::pair<const char *, T> (&table)[N], const char *name, T &value) {
+    for (const auto &[entry, entryValue]: table) {
+        if (strcmp(entry, name) != 0) continue;
+        value = entryValue;
+        return true;
+    }
+    return false;
+}
+
+void CommandLine::printUsage(const char *program) {
+    fprintf(stderr, "Usage: %s (--edges FILE [--nodes FILE] | --manifest FILE) [options]\n"
+                    "  --edges FILE       edges file of the instance to solve\n"
+                    "  --nodes FILE       nodes file with the coordinates of its stops\n"
+                    "  --manifest FILE    solve every instance listed, one \"edges file[,nodes file]\" per line\n"
+                    "  --algorithm NAME   backtracking, triangular, nearest-insertion, annealing, genetic,\n"
+                    "                     ant-colony, clustering or portfolio (default portfolio)\n"
+                    "  --threads N        threads for the solver, or workers for a manifest (default: all cores)\n"
+                    "  --time-limit MS    time budget per instance, in milliseconds (default 1000)\n"
+                    "  --memory-limit MB  with a manifest, wait to load more instances while those loaded hold more\n"
+                    "                     than MB MiB of distances (solver state isn't counted; default: no limit)\n"
+                    "  --layout LAYOUT    distance storage: packed (lower triangle), full or tiled (default packed)\n"
+                    "  --precision TYPE   double, float or fixed (hundredths) distances (default double); lengths\n"
+                    "                     are then reported with max_error, how far they can be from the exact ones\n"
+                    "  --storage-dir DIR  keep the distances in a memory-mapped file in DIR instead of in RAM\n"
+                    "  --format FORMAT    json (one object per line) or csv (default json)\n"
+                    "  --no-closure       don't complete incomplete graphs with shortest paths\n"
+                    "  --progress         print every ant colony iteration to standard error (ant-colony only)\n"
+                    "  --help             show this message\n"
+                    "Without arguments, the interactive menu starts.\n", program);
+}
+
+/**
+ * Reads the arguments into the options, reporting the first invalid one
+ * @return false if an argument is unknown, lacks its value or has an invalid one
+ */
+bool CommandLine::parse(int argc, char **argv) {
+    auto number = [](const char *text, unsigned long &value) {
+        const char *end = text + strlen(text);
+        auto [last, error] = std::from_chars(text, end, value);
+        return error == std::errc() && last == end;
+    };
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--no-closure") {
+            metricClosure = false;
+            continue;
+        }
+        if (option == "--progress") {
+            progress = true;
+            continue;
+        }
+        if (option == "--help" || option == "-h") {
+            help = true;
+            return true;
+        }
+        if (i + 1 == argc) {
+            fprintf(stderr, "Missing value for %s\n", option.c_str());
+            return false;
+        }
+        const char *value = argv[++i];
+        unsigned long parsed;
+        if (option == "--edges") edgesFile = value;
+        else if (option == "--nodes") nodesFile = value;
+        else if (option == "--manifest") manifestFile = value;
+        else if (option == "--algorithm") {
+            algorithm = value;
+            auto found = std::find_if(std::begin(ALGORITHMS), std::end(ALGORITHMS),
+                                      [&](const auto &entry) { return algorithm == entry.first; });
+            if (found == std::end(ALGORITHMS)) {
+                fprintf(stderr, "Unknown algorithm %s\n", value);
+                return false;
+            }
+            engine = found->second;
+        } else if (option == "--threads" && number(value, parsed) && parsed <= UINT_MAX) threads = parsed;
+        else if (option == "--time-limit" && number(value, parsed)) budget = std::chrono::milliseconds(parsed);
+        else if (option == "--memory-limit" && number(value, parsed) && parsed <= SIZE_MAX >> 20)
+            memoryLimit = parsed << 20;
+        else if (option == "--layout" && lookup(LAYOUTS, value, layout));
+        else if (option == "--precision" && lookup(PRECISIONS, value, precision));
+        else if (option == "--storage-dir") storageDirectory = value;
+        else if (option == "--format" && (!strcmp(value, "json") || !strcmp(value, "csv")))
+            format = strcmp(value, "json") == 0 ? Format::JSON : Format::CSV;
+        else {
+            fprintf(stderr, "Invalid argument %s %s\n", option.c_str(), value);
+            return false;
+        }
+    }
+    if (edgesFile.empty() == manifestFile.empty()) {
+        fprintf(stderr, "Give either --edges or --manifest\n");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @return Most memory the process has held so far (resident set size), in KiB; it never decreases, so in a manifest
+ * it covers every instance solved before, and those solved at the same time, not just the one it is reported with
+ */
+long CommandLine::peakMemoryKilobytes() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/**
+ * Quotes a string as a JSON string (escaping quotes, backslashes and control characters), or as a CSV field if it
+ * needs it
+ */
+std::string CommandLine::quote(const std::string &text, Format format) {
+    if (format == Format::CSV && text.find_first_of(",\"\r\n") == std::string::npos) return text;
+    std::string quoted = "\"";
+    for (char c: text) {
+        if (c == '"') quoted += format == Format::JSON ? "\\\"" : "\"\"";
+        else if (format == Format::CSV) quoted += c;
+        else if (c == '\\') quoted += "\\\\";
+        else if (c == '\n') quoted += "\\n";
+        else if (c == '\t') quoted += "\\t";
+        else if (c == '\r') quoted += "\\r";
+        else if ((unsigned char) c < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof escaped, "\\u%04x", (unsigned int) (unsigned char) c);
+            quoted += escaped;
+        } else quoted += c;
+    }
+    return quoted + "\"";
+}
+
+/**
+ * Writes the result of an instance as a JSON object on its own line, or as a CSV row
+ */
+void CommandLine::printRecord(const BatchSolver::Result &result) const {
+    std::string tour;
+    for (unsigned int stop: result.route) {
+        if (!tour.empty()) tour += format == Format::JSON ? "," : " ";
+        tour += std::to_string(stop);
+    }
+    char length[32] = "null";
+    if (result.length != constants::INF) snprintf(length, sizeof length, "%.2f", result.length);
+    else if (format == Format::CSV) length[0] = '\0';
+    char maxError[32];
+    snprintf(maxError, sizeof maxError, "%.6g", result.maxError);
+    if (format == Format::JSON) {
+        printf("{\"edges\":%s,\"nodes\":%s,\"algorithm\":%s,\"loaded\":%s,\"stops\":%u,\"length\":%s,"
+               "\"max_error\":%s,\"optimal\":%s,\"engine\":%s,\"load_ms\":%.3f,\"solve_ms\":%.3f,"
+               "\"process_peak_rss_kb\":%ld,\"tour\":[%s]}\n",
+               quote(result.instance.edgesFile, format).c_str(), quote(result.instance.nodesFile, format).c_str(),
+               quote(algorithm, format).c_str(), result.loaded ? "true" : "false", result.stops, length, maxError,
+               result.optimal ? "true" : "false", quote(result.engine, format).c_str(), result.loadMilliseconds,
+               result.solveMilliseconds, peakMemoryKilobytes(), tour.c_str());
+    } else {
+        printf("%s,%s,%s,%s,%u,%s,%s,%s,%s,%.3f,%.3f,%ld,%s\n", quote(result.instance.edgesFile, format).c_str(),
+               quote(result.instance.nodesFile, format).c_str(), quote(algorithm, format).c_str(),
+               result.loaded ? "true" : "false", result.stops, length, maxError, result.optimal ? "true" : "false",
+               quote(result.engine, format).c_str(), result.loadMilliseconds, result.solveMilliseconds,
+               peakMemoryKilobytes(), tour.c_str());
+    }
+    fflush(stdout);
+}
+
+/**
+ * Solves what the arguments ask for: a single instance with the solver using every thread, or a manifest with one
+ * instance per worker thread, each solver using one (see BatchSolver)
+ * Builds with instrumentation also write its report to stderr at the end, as JSON or as text for CSV output
+ * @return Exit status: 0 on success, 1 for invalid arguments or an unreadable manifest, 2 if an instance couldn't be
+ * loaded
+ */
+int CommandLine::run(int argc, char **argv) {
+    if (!parse(argc, argv)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (help) {
+        printUsage(argv[0]);
+        return 0;
+    }
+    std::vector<BatchSolver::Instance> instances;
+    BatchSolver::Options options;
+    options.engine = engine;
+    options.budget.time = budget;
+    options.metricClosure = metricClosure;
+    options.layout = layout;
+    options.precision = precision;
+    options.storageDirectory = storageDirectory;
+    if (progress) {
+        options.onColonyIteration = [](size_t index, const Graph::colony_iteration_t &stats) {
+            fprintf(stderr, "instance %zu iteration %lu elapsed_ms %.3f iteration_ms %.3f iteration_best %.2f "
+                            "best %.2f\n", index, stats.iteration, stats.elapsed, stats.milliseconds,
+                    stats.iterationBest, stats.best);
+        };
+    }
+    if (manifestFile.empty()) {
+        instances.push_back({edgesFile, nodesFile});
+        options.workers = 1;
+        options.solverThreads = parallel::threadCount(threads);
+    } else {
+        if (!BatchSolver::readManifest(manifestFile, instances)) {
+            fprintf(stderr, "Couldn't open %s\n", manifestFile.c_str());
+            return 1;
+        }
+        options.workers = threads;
+        options.memoryLimit = memoryLimit;
+    }
+
+    if (format == Format::CSV)
+        printf("edges,nodes,algorithm,loaded,stops,length,max_error,optimal,engine,load_ms,solve_ms,"
+               "process_peak_rss_kb,tour\n");
+    BatchSolver batch(options, [this](const BatchSolver::Result &result) { printRecord(result); });
+    BatchSolver::Summary summary = batch.run(instances);
+    if (!manifestFile.empty())
+        fprintf(stderr, "%zu instances (%zu failed) in %.3f s, %.2f instances per second, at most %.1f MiB of "
+                        "distances loaded at once\n", instances.size(), summary.failed, summary.seconds,
+                summary.instancesPerSecond, (double) summary.peakMemory / (1 << 20));
+    if constexpr (instrumentation::ENABLED) { //On stderr, so the records stay machine-readable
+        instrumentation::Report report = instrumentation::collect();
+        fprintf(stderr, "%s\n", format == Format::JSON ? report.toJson().c_str() : report.toText().c_str());
+    }
+    return summary.failed == 0 ? 0 : 2;
+}
@@ -0,0 +1,53 @@
+#ifndef TRAVELLINGSALESMAN_COMMANDLINE_H
+#define TRAVELLINGSALESMAN_COMMANDLINE_H
+
+#include <chrono>
+#include <string>
+#include "batchSolver.h"
+#include "solverHandle.h"
+
+/**
+ * Non-interactive mode: solves the instance or the manifest of instances given as arguments and writes one JSON
+ * object per line, or CSV rows, to standard output, with the tour, its length (and how far it can be from the exact
+ * one, with FLOAT or FIXED distance storage), load and solve times and the peak memory of the process so far
+ * Usage and errors go to standard error, so the output can be piped as is
+ */
+class CommandLine {
+  public:
+    enum class Format {
+        JSON, CSV
+    };
+
+  private:
+    std::string edgesFile;
+    std::string nodesFile;
+    std::string manifestFile;
+    std::string algorithm = "portfolio";
+    SolverHandle::Engine engine = SolverHandle::Engine::PORTFOLIO;
+    unsigned int threads = 0;
+    std::chrono::milliseconds budget = std::chrono::milliseconds(1000);
+    size_t memoryLimit = 0; // bytes of distance storage a manifest may load at once (0 for no limit)
+    Format format = Format::JSON;
+    bool metricClosure = true;
+    bool progress = false;
+    DistanceMatrix::Layout layout = DistanceMatrix::Layout::PACKED;
+    DistanceMatrix::Precision precision = DistanceMatrix::Precision::DOUBLE;
+    std::string storageDirectory;
+    bool help = false;
+
+    bool parse(int argc, char **argv);
+
+    static void printUsage(const char *program);
+
+    static std::string quote(const std::string &text, Format format);
+
+    void printRecord(const BatchSolver::Result &result) const;
+
+  public:
+    static long peakMemoryKilobytes();
+
+    int run(int argc, char **argv);
+};
+
+
+#endif //TRAVELLINGSALESMAN_COMMANDLINE_H
@@ -0,0 +1,61 @@
+#include "concurrentUFDS.h"
+#include <utility>
+
+ConcurrentUFDS::ConcurrentUFDS(unsigned int n) : path(n) {
+    for (unsigned int i = 0; i < n; i++) path[i].store(i, std::memory_order_relaxed);
+}
+
+unsigned int ConcurrentUFDS::size() const {
+    return (unsigned int) path.size();
+}
+
+/**
+ * Finds the root of the set of a node, pointing every node visited to its grandparent on the way
+ * A failed compare-and-swap only means another thread shortened the path first, so it isn't retried
+ * Parent pointers only ever move up the tree, hence relaxed ordering is enough for the pointers themselves;
+ * callers that publish other data alongside a merge must synchronise it separately (e.g. by joining threads)
+ * Time Complexity: O(log(n)) (amortized)
+ * @param i - Node
+ * @return Root of the set, which may stop being one if another thread links it concurrently
+ */
+unsigned int ConcurrentUFDS::findSet(unsigned int i) {
+    while (true) {
+        unsigned int parent = path[i].load(std::memory_order_relaxed);
+        if (parent == i) return i;
+        unsigned int grandparent = path[parent].load(std::memory_order_relaxed);
+        if (parent != grandparent) path[i].compare_exchange_weak(parent, grandparent, std::memory_order_relaxed);
+        i = grandparent;
+    }
+}
+
+/**
+ * Time Complexity: O(log(n)) (amortized)
+ * @return true if both nodes are in the same set; a false answer may be outdated by a concurrent merge
+ */
+bool ConcurrentUFDS::isSameSet(unsigned int i, unsigned int j) {
+    while (true) {
+        i = findSet(i);
+        j = findSet(j);
+        if (i == j) return true;
+        //Two different roots only prove the sets are disjoint if the first one is still a root
+        if (path[i].load(std::memory_order_relaxed) == i) return false;
+    }
+}
+
+/**
+ * Merges the sets of two nodes
+ * Time Complexity: O(log(n)) (amortized, without contention)
+ * @return true if this call merged two different sets, false if they were already the same set
+ */
+bool ConcurrentUFDS::linkSets(unsigned int i, unsigned int j) {
+    while (true) {
+        unsigned int x = findSet(i), y = findSet(j);
+        if (x == y) return false;
+        if (x > y) std::swap(x, y);
+        unsigned int expected = x;
+        if (path[x].compare_exchange_strong(expected, y, std::memory_order_relaxed)) return true;
+        //x was linked by another thread in the meantime, so look the roots up again
+        i = x;
+        j = y;
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef TRAVELLINGSALESMAN_CONCURRENTUFDS_H
+#define TRAVELLINGSALESMAN_CONCURRENTUFDS_H
+
+#include <vector>
+#include <atomic>
+
+/**
+ * Union-Find Disjoint Set that several threads can query and merge at the same time, without locks
+ * Every parent pointer is an atomic: findSet halves paths with compare-and-swap and linkSets hangs one root under
+ * the other with a single compare-and-swap, retrying if another thread changed that root first
+ * Roots are linked by index (the smaller under the larger), which needs no extra state to agree on;
+ * for single-threaded use the plain UFDS is cheaper
+ */
+class ConcurrentUFDS {
+  private:
+    std::vector<std::atomic<unsigned int>> path; // ancestor of each node (the node itself for a root)
+
+  public:
+    explicit ConcurrentUFDS(unsigned int n = 0);
+
+    [[nodiscard]] unsigned int size() const;
+
+    unsigned int findSet(unsigned int i);
+
+    bool isSameSet(unsigned int i, unsigned int j);
+
+    bool linkSets(unsigned int i, unsigned int j);
+};
+
+
+#endif //TRAVELLINGSALESMAN_CONCURRENTUFDS_H
@@ -9,6 +9,7 @@
 
 namespace constants {
     const double INF = std::numeric_limits<double>::infinity();
+    const unsigned int NO_VERTEX = std::numeric_limits<unsigned int>::max();
 }
 
 #endif //TRAVELLINGSALESMAN_CONSTANTS_H
@@ -34,6 +34,33 @@ double Coordinates::distanceTo(Coordinates point) const {
     return rad * c;
 }
 
+/**
+ * Calculates the point on the unit sphere at these coordinates, for use with distanceBetween
+ * Time Complexity: O(1)
+ * @return Cartesian coordinates of the point (NaN if these coordinates are unknown)
+ */
+std::array<double, 3> Coordinates::toUnitVector() const {
+    if (latitude == 0 && longitude == 0) return {NAN, NAN, NAN};
+    double lat = latitude * M_PI / 180.0, lon = longitude * M_PI / 180.0;
+    return {cos(lat) * cos(lon), cos(lat) * sin(lon), sin(lat)};
+}
+
+/**
+ * Calculates the haversine distance between two points given by their unit vectors, from the chord joining them
+ * Gives the same distance as distanceTo with a single square root and arcsine, for loops over many pairs
+ * Time Complexity: O(1)
+ * @param u - Unit vector of the first point
+ * @param v - Unit vector of the second point
+ * @return Haversine distance between the two points, or -1 if either is unknown
+ */
+double Coordinates::distanceBetween(const std::array<double, 3> &u, const std::array<double, 3> &v) {
+    double dx = u[0] - v[0], dy = u[1] - v[1], dz = u[2] - v[2];
+    double chord = sqrt(dx * dx + dy * dy + dz * dz);
+    if (std::isnan(chord)) return -1;
+    double rad = 6371;
+    return rad * 2 * asin(std::min(1.0, chord / 2));
+}
+
 double Coordinates::getLatitude() const {
     return latitude;
 }
@@ -6,6 +6,7 @@
 #define TRAVELLINGSALESMAN_COORDINATES_H
 
 #include <cmath>
+#include <array>
 
 class Coordinates {
 private:
@@ -24,6 +25,10 @@ public:
 
     [[nodiscard]] double distanceTo(Coordinates c) const;
 
+    [[nodiscard]] std::array<double, 3> toUnitVector() const;
+
+    static double distanceBetween(const std::array<double, 3> &u, const std::array<double, 3> &v);
+
     bool operator==(const Coordinates &rhs) const;
 
     bool operator!=(const Coordinates &rhs) const;
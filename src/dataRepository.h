@@ -1,36 +1,34 @@
 #ifndef TRAVELLINGSALESMAN_DATAREPOSITORY_H
 #define TRAVELLINGSALESMAN_DATAREPOSITORY_H
 
-#include <algorithm>
-#include <iostream>
+#include <vector>
 #include <optional>
-#include <memory>
-#include "vertex.h"
 #include "coordinates.h"
 
+/**
+ * Stops read from a nodes file, in the order they were read: their dataset ids and coordinates in parallel arrays,
+ * plus the running sums needed for their average location
+ */
 class DataRepository {
 
 private:
-    VertexPointerTable vertices;
+    std::vector<unsigned int> ids;        // dataset id of each stop
+    std::vector<Coordinates> coordinates; // coordinates of each stop
     double sumLatitude = 0;
     double sumLongitude = 0;
 
 public:
     DataRepository();
 
-    const VertexPointerTable &getVertices() const;
-
-    void setVertices(const VertexPointerTable &vertices);
-
-    std::shared_ptr<Vertex> findVertex(const unsigned int &id);
+    [[nodiscard]] unsigned int size() const;
 
     double getAverageLatitude();
 
     double getAverageLongitude();
 
-    Vertex &getFurthestVertex();
+    std::optional<unsigned int> getFurthestVertex();
 
-    std::shared_ptr<Vertex> addVertexEntry(unsigned int id, double latitude, double longitude);
+    void addVertexEntry(unsigned int id, double latitude, double longitude);
 
     void clearData();
 };
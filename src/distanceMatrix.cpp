@@ -0,0 +1,132 @@
+#include "distanceMatrix.h"
+#include <cstring>
+
+DistanceMatrix::DistanceMatrix(Layout layout, Precision precision, double scale, const std::string &backingDirectory)
+        : layout(layout), precision(precision), scale(scale), inverseScale(1 / scale), buffer(backingDirectory) {}
+
+size_t DistanceMatrix::elementSize() const {
+    return precision == Precision::DOUBLE ? sizeof(double) : sizeof(float);
+}
+
+/**
+ * Grows the matrix to newSize vertices, with every new entry set to constants::INF
+ * Time Complexity: O(newSize) amortized for PACKED and TILED | O(newSize²) when the FULL layout has to reallocate
+ * @param newSize - New number of vertices
+ */
+void DistanceMatrix::resize(unsigned int newSize) {
+    if (newSize <= n) return;
+
+    size_t oldEntries = buffer.size() / elementSize();
+    if (layout == Layout::PACKED || layout == Layout::TILED) {
+        size_t tileRows = (newSize + TILE - 1) / TILE;
+        size_t entries = layout == Layout::PACKED ? (size_t) newSize * (newSize + 1) / 2 : tileStart(tileRows, 0);
+        if (entries > oldEntries) {
+            buffer.resize(entries * elementSize());
+            for (size_t k = oldEntries; k < entries; k++) store(k, constants::INF);
+        }
+    } else if (newSize > stride) {
+        size_t newStride = std::max((size_t) newSize, stride * 2);
+        StorageBuffer oldBuffer = std::move(buffer);
+        buffer = StorageBuffer(oldBuffer.getDirectory());
+        buffer.resize(newStride * newStride * elementSize());
+        for (size_t k = 0; k < newStride * newStride; k++) store(k, constants::INF);
+        for (size_t i = 0; i < n; i++)
+            std::memcpy(buffer.data() + i * newStride * elementSize(), oldBuffer.data() + i * stride * elementSize(),
+                        n * elementSize());
+        stride = newStride;
+    }
+    n = newSize;
+}
+
+/**
+ * Hints that row i is about to be read, so a file-backed matrix starts paging it in
+ * Only the part of the row left of the diagonal is contiguous, so that is the part requested
+ * Time Complexity: O(1)
+ * @param i - Row to be read
+ */
+void DistanceMatrix::prefetchRow(unsigned int i) const {
+    size_t first, last;
+    switch (layout) {
+        case Layout::PACKED:
+            first = packedIndex(i, 0), last = packedIndex(i + 1, 0);
+            break;
+        case Layout::TILED:
+            first = tileStart(i / TILE, 0), last = tileStart(i / TILE + 1, 0);
+            break;
+        default:
+            first = i * stride, last = first + n;
+            break;
+    }
+    buffer.advise(StorageBuffer::Access::WILLNEED, first * elementSize(), (last - first) * elementSize());
+}
+
+unsigned int DistanceMatrix::size() const {
+    return n;
+}
+
+DistanceMatrix::Layout DistanceMatrix::getLayout() const {
+    return layout;
+}
+
+DistanceMatrix::Precision DistanceMatrix::getPrecision() const {
+    return precision;
+}
+
+double DistanceMatrix::getScale() const {
+    return scale;
+}
+
+bool DistanceMatrix::isMapped() const {
+    return buffer.isMapped();
+}
+
+/**
+ * Changes the storage layout, element type and location, keeping every stored length (rounded to the new precision)
+ * Time Complexity: O(n²)
+ * @param newLayout - Layout to convert to
+ * @param newPrecision - Element type to convert to
+ * @param newScale - Multiplier applied to lengths before rounding, used by FIXED only
+ * @param backingDirectory - Directory for the memory-mapped backing file, or empty to keep the matrix on the heap
+ */
+void DistanceMatrix::convert(Layout newLayout, Precision newPrecision, double newScale,
+                             const std::string &backingDirectory) {
+    if (newLayout == layout && newPrecision == precision && newScale == scale &&
+        backingDirectory == buffer.getDirectory())
+        return;
+
+    DistanceMatrix converted(newLayout, newPrecision, newScale, backingDirectory);
+    converted.resize(n);
+    forEachEntry([&converted](unsigned int i, unsigned int j, double length) { converted.set(i, j, length); });
+    *this = std::move(converted);
+}
+
+/**
+ * Upper bound on how far a sum of stored lengths can be from the same sum over the exact lengths
+ * Time Complexity: O(1)
+ * @param length - Value of the sum
+ * @param edges - Number of lengths added
+ * @return Maximum absolute error
+ */
+double DistanceMatrix::getMaxError(double length, unsigned int edges) const {
+    switch (precision) {
+        case Precision::FLOAT:
+            return length * std::ldexp(1.0, -24);
+        case Precision::FIXED:
+            return edges * 0.5 * inverseScale;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @return Number of bytes held by the matrix buffer, in RAM or in its backing file
+ */
+size_t DistanceMatrix::getMemoryUsage() const {
+    return buffer.capacity();
+}
+
+void DistanceMatrix::clear() {
+    buffer.clear();
+    n = 0;
+    stride = 0;
+}
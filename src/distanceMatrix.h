@@ -0,0 +1,264 @@
+#ifndef TRAVELLINGSALESMAN_DISTANCEMATRIX_H
+#define TRAVELLINGSALESMAN_DISTANCEMATRIX_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <type_traits>
+#include <algorithm>
+#include <string>
+#include "constants.h"
+#include "storageBuffer.h"
+
+/**
+ * Symmetric matrix of edge lengths between dense vertex ids, where missing edges are stored as constants::INF
+ * FULL keeps every row of the square matrix; PACKED keeps only the rows of the lower triangle (diagonal included)
+ * one after the other, which halves memory and lets new vertices be appended without moving existing rows
+ * TILED splits the lower triangle into TILE x TILE blocks stored one after the other (a page of floats each),
+ * so a row touches a handful of whole pages and the matrix can live in a memory-mapped file
+ *
+ * Lengths are always read back as double, so sums keep double precision whatever the element type:
+ * - DOUBLE stores them exactly
+ * - FLOAT stores them with a relative error of at most 2^-24 per edge, so a tour is off by at most 2^-24 of its length
+ * - FIXED stores round(length * scale) in 32 bits, so each edge is off by at most 0.5 / scale and a tour of k edges
+ *   by at most k * 0.5 / scale; lengths above (2^32 - 2) / scale are saturated
+ */
+class DistanceMatrix {
+  public:
+    enum class Layout {
+        FULL, PACKED, TILED
+    };
+
+    static constexpr unsigned int TILE = 32;
+
+    enum class Precision {
+        DOUBLE, FLOAT, FIXED
+    };
+
+  private:
+    static constexpr uint32_t FIXED_INF = UINT32_MAX;
+
+    Layout layout;
+    Precision precision;
+    double scale;  // FIXED only: stored value = round(length * scale)
+    double inverseScale;
+    unsigned int n = 0;
+    size_t stride = 0; // row length of the FULL layout (grows geometrically)
+    StorageBuffer buffer;
+
+    /**
+     * Branch-free position of entry (i, j) in the PACKED buffer: row max(i, j), column min(i, j)
+     */
+    [[nodiscard]] static size_t packedIndex(unsigned int i, unsigned int j) {
+        unsigned int mask = -(unsigned int) (i < j);
+        size_t hi = i ^ ((i ^ j) & mask);
+        size_t lo = j ^ ((i ^ j) & mask);
+        return hi * (hi + 1) / 2 + lo;
+    }
+
+    /**
+     * Branch-free position of entry (i, j) in the TILED buffer: tile (max / TILE, min / TILE) of the packed triangle
+     * of tiles, then row-major inside the tile
+     */
+    [[nodiscard]] static size_t tiledIndex(unsigned int i, unsigned int j) {
+        unsigned int mask = -(unsigned int) (i < j);
+        size_t hi = i ^ ((i ^ j) & mask);
+        size_t lo = j ^ ((i ^ j) & mask);
+        return tileStart(hi / TILE, lo / TILE) + (hi % TILE) * TILE + lo % TILE;
+    }
+
+    [[nodiscard]] static size_t tileStart(size_t tileRow, size_t tileColumn) {
+        return (tileRow * (tileRow + 1) / 2 + tileColumn) * TILE * TILE;
+    }
+
+    [[nodiscard]] size_t index(unsigned int i, unsigned int j) const {
+        switch (layout) {
+            case Layout::PACKED:
+                return packedIndex(i, j);
+            case Layout::TILED:
+                return tiledIndex(i, j);
+            default:
+                return i * stride + j;
+        }
+    }
+
+    template<typename T, typename F>
+    void walkAll(F &f) const {
+        const T *data = elements<T>();
+        auto value = [this](T v) -> double {
+            if constexpr (std::is_same_v<T, uint32_t>) return decode(v);
+            else return v;
+        };
+        if (layout == Layout::TILED) {
+            size_t k = 0;
+            for (unsigned int tileRow = 0; tileRow * TILE < n; tileRow++)
+                for (unsigned int tileColumn = 0; tileColumn <= tileRow; tileColumn++)
+                    for (unsigned int i = tileRow * TILE; i < tileRow * TILE + TILE; i++)
+                        for (unsigned int j = tileColumn * TILE; j < tileColumn * TILE + TILE; j++, k++)
+                            if (j < i && i < n) f(i, j, value(data[k]));
+            return;
+        }
+        for (unsigned int i = 0; i < n; i++) {
+            const T *row = data + index(i, 0);
+            for (unsigned int j = 0; j < i; j++) f(i, j, value(row[j]));
+        }
+    }
+
+    template<typename T>
+    [[nodiscard]] const T *elements() const {
+        return reinterpret_cast<const T *>(buffer.data());
+    }
+
+    template<typename T>
+    [[nodiscard]] T *elements() {
+        return reinterpret_cast<T *>(buffer.data());
+    }
+
+    [[nodiscard]] double decode(uint32_t value) const {
+        return value == FIXED_INF ? constants::INF : value * inverseScale;
+    }
+
+    [[nodiscard]] uint32_t encode(double length) const {
+        if (length == constants::INF) return FIXED_INF;
+        double scaled = std::round(length * scale);
+        return scaled >= FIXED_INF - 1.0 ? FIXED_INF - 1 : (uint32_t) scaled;
+    }
+
+    void store(size_t k, double length) {
+        switch (precision) {
+            case Precision::DOUBLE:
+                elements<double>()[k] = length;
+                break;
+            case Precision::FLOAT:
+                elements<float>()[k] = (float) length;
+                break;
+            case Precision::FIXED:
+                elements<uint32_t>()[k] = encode(length);
+                break;
+        }
+    }
+
+    template<typename T, typename F>
+    void walkRow(unsigned int i, F &f) const {
+        const T *data = elements<T>();
+        auto value = [this](T v) -> double {
+            if constexpr (std::is_same_v<T, uint32_t>) return decode(v);
+            else return v;
+        };
+        if (layout == Layout::FULL) {
+            const T *row = data + i * stride;
+            for (unsigned int j = 0; j < n; j++) if (j != i) f(j, value(row[j]));
+            return;
+        }
+        if (layout == Layout::TILED) {
+            //Row i inside the tiles to the left of the diagonal, then column i inside the tiles below it
+            unsigned int tileRow = i / TILE;
+            for (unsigned int tileColumn = 0; tileColumn <= tileRow; tileColumn++) {
+                const T *row = data + tileStart(tileRow, tileColumn) + (i % TILE) * TILE;
+                unsigned int first = tileColumn * TILE, last = std::min(first + TILE, i);
+                for (unsigned int j = first; j < last; j++) f(j, value(row[j - first]));
+            }
+            for (unsigned int j = i + 1; j < n; j++) f(j, value(data[tiledIndex(j, i)]));
+            return;
+        }
+        const T *row = data + packedIndex(i, 0);
+        for (unsigned int j = 0; j < i; j++) f(j, value(row[j]));
+        size_t k = packedIndex(i + 1, i);
+        for (unsigned int j = i + 1; j < n; j++) {
+            f(j, value(data[k]));
+            k += j + 1;
+        }
+    }
+
+    [[nodiscard]] size_t elementSize() const;
+
+  public:
+    explicit DistanceMatrix(Layout layout = Layout::PACKED, Precision precision = Precision::DOUBLE,
+                            double scale = 100, const std::string &backingDirectory = "");
+
+    [[nodiscard]] double get(unsigned int i, unsigned int j) const {
+        size_t k = index(i, j);
+        switch (precision) {
+            case Precision::DOUBLE:
+                return elements<double>()[k];
+            case Precision::FLOAT:
+                return elements<float>()[k];
+            default:
+                return decode(elements<uint32_t>()[k]);
+        }
+    }
+
+    void set(unsigned int i, unsigned int j, double length) {
+        store(index(i, j), length);
+        if (layout == Layout::FULL) store(index(j, i), length);
+    }
+
+    /**
+     * Calls f(j, length) for every column j != i of row i, walking the storage in memory order
+     * PACKED rows are read contiguously up to the diagonal and the rest of the row is read down column i
+     * Time Complexity: O(n)
+     */
+    template<typename F>
+    void forEachInRow(unsigned int i, F f) const {
+        if (buffer.isMapped()) prefetchRow(i);
+        switch (precision) {
+            case Precision::DOUBLE:
+                walkRow<double>(i, f);
+                break;
+            case Precision::FLOAT:
+                walkRow<float>(i, f);
+                break;
+            case Precision::FIXED:
+                walkRow<uint32_t>(i, f);
+                break;
+        }
+    }
+
+    /**
+     * Calls f(i, j, length) once for every pair j < i, walking the whole storage in memory order
+     * Time Complexity: O(n²)
+     */
+    template<typename F>
+    void forEachEntry(F f) const {
+        buffer.advise(StorageBuffer::Access::SEQUENTIAL);
+        switch (precision) {
+            case Precision::DOUBLE:
+                walkAll<double>(f);
+                break;
+            case Precision::FLOAT:
+                walkAll<float>(f);
+                break;
+            case Precision::FIXED:
+                walkAll<uint32_t>(f);
+                break;
+        }
+        buffer.advise(StorageBuffer::Access::NORMAL);
+    }
+
+    void prefetchRow(unsigned int i) const;
+
+    void resize(unsigned int newSize);
+
+    [[nodiscard]] unsigned int size() const;
+
+    [[nodiscard]] Layout getLayout() const;
+
+    [[nodiscard]] Precision getPrecision() const;
+
+    [[nodiscard]] double getScale() const;
+
+    [[nodiscard]] bool isMapped() const;
+
+    void convert(Layout newLayout, Precision newPrecision, double newScale = 100,
+                 const std::string &backingDirectory = "");
+
+    [[nodiscard]] double getMaxError(double length, unsigned int edges) const;
+
+    [[nodiscard]] size_t getMemoryUsage() const;
+
+    void clear();
+};
+
+
+#endif //TRAVELLINGSALESMAN_DISTANCEMATRIX_H
@@ -1,14 +1,15 @@
 #include "graph.h"
+#include "parallel.h"
+#include "concurrentUFDS.h"
+#include "xoshiro.h"
+#include "tourArena.h"
+#include "instrumentation.h"
 
 Graph::Graph() = default;
 
 
 unsigned int Graph::getNumVertex() const {
-    return (unsigned int) vertexSet.size();
-}
-
-std::vector<std::shared_ptr<Vertex>> Graph::getVertexSet() const {
-    return vertexSet;
+    return (unsigned int) coordinates.size();
 }
 
 unsigned int Graph::getTotalEdges() const {
@@ -16,64 +17,79 @@ unsigned int Graph::getTotalEdges() const {
 }
 
 /**
- * Finds the vertex with a given id
+ * Finds the vertex with a given dataset id
+ * Time Complexity: O(1) (average case)
+ * @param externalId - Id of the vertex in the dataset files
+ * @return Dense id of the found vertex, or std::nullopt if none was found
+ */
+std::optional<unsigned int> Graph::findVertexByExternalId(const unsigned int &externalId) const {
+    return ids.find(externalId);
+}
+
+/**
+ * Translates a dense vertex id back into the id used in the dataset files
  * Time Complexity: O(1)
- * @param id - Id of the vertex to be found
- * @return Pointer to the found Vertex, or nullptr if none was found
+ * @param id - Dense id of the vertex
+ * @return Id of the vertex in the dataset files
  */
-std::shared_ptr<Vertex> Graph::findVertex(const unsigned int &id) const {
-    return vertexSet.size() <= id ? nullptr : vertexSet[id];
+unsigned int Graph::getExternalId(const unsigned int &id) const {
+    return ids.toExternal(id);
+}
+
+const Coordinates &Graph::getCoordinates(const unsigned int &id) const {
+    return coordinates[id];
+}
+
+void Graph::setCoordinates(const unsigned int &id, const Coordinates &c) {
+    coordinates[id] = c;
 }
 
 /**
  * Finds length of the edge connecting two vertices (if it doesn't explicitly exist, it returns the haversine distance)
  * Time Complexity: O(1)
- * @param v1id - Pointer to the first vertex
- * @param v2id - Pointer to the second vertex
+ * @param v1id - Id of the first vertex
+ * @param v2id - Id of the second vertex
  */
-double Graph::findEdge(const std::shared_ptr<Vertex> &v1, const std::shared_ptr<Vertex> &v2) const {
-    unsigned int v1id = v1->getId();
-    unsigned int v2id = v2->getId();
-
+double Graph::findEdge(const unsigned int &v1id, const unsigned int &v2id) const {
     if (v1id == v2id) return -2;
-    if (distanceMatrix[v1id].size() > v2id && distanceMatrix[v1id][v2id] != constants::INF)
-        return distanceMatrix[v1id][v2id];
+    instrumentation::count(instrumentation::Counter::DISTANCE_LOOKUPS);
+    double length = distanceMatrix.get(v1id, v2id);
+    if (length != constants::INF)
+        return length;
     else { //haversine function
-        return v1->haversineDistance(v2);
+        instrumentation::count(instrumentation::Counter::HAVERSINE_FALLBACKS);
+        return coordinates[v1id].distanceTo(coordinates[v2id]);
     }
 }
 
 /**
- * Adds a vertex with a given id to the Graph
- * Time Complexity: O(1) (average case) | O(|V|) (worst case)
- * @param id - Id of the Vertex to add
- * @return Pointer to new Vertex object
+ * Adds a vertex with a given dataset id to the Graph, assigning it the next dense id
+ * If the vertex already exists, it is left unchanged
+ * Time Complexity: O(1) (amortized average case)
+ * @param externalId - Id of the Vertex to add, as read from the dataset files
+ * @param c - Coordinates of the Vertex to add
+ * @return Dense id of the vertex
  */
-std::shared_ptr<Vertex> Graph::addVertex(const unsigned int &id, Coordinates c) {
-    std::shared_ptr<Vertex> newVertex = nullptr;
-    if (vertexSet.size() <= id) { vertexSet.resize(id + 1); }
-    newVertex = std::make_shared<Vertex>(id, c);
-    vertexSet[id] = newVertex;
+unsigned int Graph::addVertex(const unsigned int &externalId, Coordinates c) {
+    unsigned int id = ids.insert(externalId);
+    if (id < coordinates.size()) return id;
 
-    return newVertex;
+    coordinates.push_back(c);
+    distanceMatrix.resize(coordinates.size());
+    return id;
 }
 
 /**
  * Adds a bidirectional edge to the Graph between the vertices with id source and dest, and a given length
- * Time Complexity: O(|V|)
- * @param source - Id of the source Vertex
- * @param dest - Id of the destination Vertex
+ * Time Complexity: O(1)
+ * @param source - Dense id of the source Vertex
+ * @param dest - Dense id of the destination Vertex
  * @param length - Length of the Edge to be added
  */
 void
 Graph::addBidirectionalEdge(const unsigned int &source, const unsigned int &dest, double length) {
-    if (distanceMatrix.size() <= source) distanceMatrix.resize(source + 1, {constants::INF});
-    if (distanceMatrix[source].size() <= dest) distanceMatrix[source].resize(dest + 1, constants::INF);
-    distanceMatrix[source][dest] = length;
-
-    if (distanceMatrix.size() <= dest) distanceMatrix.resize(dest + 1, {constants::INF});
-    if (distanceMatrix[dest].size() <= source) distanceMatrix[dest].resize(source + 1, constants::INF);
-    distanceMatrix[dest][source] = length;
+    distanceMatrix.set(source, dest, length);
+    adjacencyValid.store(false, std::memory_order_relaxed);
     totalEdges++;
 }
 
@@ -82,179 +98,476 @@ Graph::addBidirectionalEdge(const unsigned int &source, const unsigned int &dest
  * DFS traversal variation that sets the visited attribute to true of the vertices the DFS traverses to
  * Time Complexity: O(|V|²)
  * @param source - Vertex where the DFS starts
+ * @param context - Context whose visited marks are set
 */
-void Graph::visitedDFS(const std::shared_ptr<Vertex> &source) {
-    source->setVisited(true);
-    for (size_t i = 0; i < vertexSet.size(); i++) {
-        if (distanceMatrix[source->getId()][i] != constants::INF &&
-            source->getId() != i) { //edge existe e não é para si mesma
-            std::shared_ptr<Vertex> v = findVertex(i);
-            if (!v->isVisited()) {
-                visitedDFS(v);
-            }
+void Graph::visitedDFS(const unsigned int &source, SolveContext &context) const {
+    context.visited[source] = true;
+    distanceMatrix.forEachInRow(source, [&](unsigned int i, double length) {
+        if (length != constants::INF && !context.visited[i]) { //edge existe
+            visitedDFS(i, context);
         }
-    }
+    });
+}
+
+/**
+ * Index of the smallest key, scanning four lanes at a time so the compiler can vectorise the reduction
+ * Time Complexity: O(n)
+ * @param keys - Array of keys
+ * @param n - Number of keys
+ * @return Index of the first smallest key (0 if n is 0)
+ */
+static unsigned int minKeyIndex(const double *keys, unsigned int n) {
+    double lane[4] = {constants::INF, constants::INF, constants::INF, constants::INF};
+    unsigned int i = 0;
+    for (; i + 4 <= n; i += 4)
+        for (unsigned int k = 0; k < 4; k++) lane[k] = keys[i + k] < lane[k] ? keys[i + k] : lane[k];
+    double min = std::min(std::min(lane[0], lane[1]), std::min(lane[2], lane[3]));
+    for (; i < n; i++) min = keys[i] < min ? keys[i] : min;
+
+    for (i = 0; i < n; i++) if (keys[i] == min) return i;
+    return 0;
+}
+
+/**
+ * @brief Builds a MST rooted at vertex 0, choosing the Prim variant that suits the edge density
+ * Dense graphs use the array-scan version, sparse ones the heap version over adjacency lists
+ * Each vertex's parent in the tree is stored in the context's parent (constants::NO_VERTEX for the root and
+ * unreachable vertices) and the length of the edge to it in dist
+ * Time Complexity: O(min(|V|², |E|log(|V|) + |V|²)), see primDense and primSparse
+ * @param context - Context that receives the tree
+ * @return Total length of the tree
+ */
+double Graph::prim(SolveContext &context) const {
+    instrumentation::Scope phase(instrumentation::Phase::MST);
+    double n = getNumVertex();
+    return (double) totalEdges * std::log2(std::max(n, 2.0)) < n * n ? primSparse(context) : primDense(context);
+}
+
+/**
+ * @brief Builds a MST using the array-scan version of Prim's algorithm, with no priority queue
+ * Each step adds the vertex with the smallest key, found with a linear scan, and relaxes its row
+ * Time Complexity: O(|V|²)
+ * @param context - Context that receives the tree
+ * @return Total length of the tree
+ */
+double Graph::primDense(SolveContext &context) const {
+    return primTree(context, 0, [](unsigned int, unsigned int, double length) { return length; });
 }
 
 /**
- * @brief Builds a MST using Prim's algorithm
+ * Array-scan Prim's algorithm over adjusted edge lengths (see primDense)
  * Time Complexity: O(|V|²)
+ * @param context - Context that receives the tree
+ * @param root - Vertex the tree grows from
+ * @param adjust - Callable adjust(v, i, length) giving the length to use for the stored edge (v, i)
+ *                 (constants::INF leaves the edge out)
+ * @return Total adjusted length of the tree
  */
-void Graph::prim() {
-    MutablePriorityQueue<Vertex> q;
-    std::vector<std::vector<bool>> newMatrix(vertexSet.size(), std::vector<bool>(vertexSet.size(), false));
-    this->selectedEdges = newMatrix;
+template<typename Adjust>
+double Graph::primTree(SolveContext &context, unsigned int root, Adjust adjust) const {
+    unsigned int n = getNumVertex();
+    context.prepare(n);
+    if (n == 0) return 0;
+    std::vector<bool> &visited = context.visited;
+    std::vector<double> &dist = context.dist;
+    std::vector<unsigned int> &parent = context.parent;
+    std::vector<double> &key = context.key;
+    key.assign(n, constants::INF); //Vertices already in the tree keep an infinite key
+
+    double weight = 0;
+    key[root] = 0;
+    for (unsigned int step = 0; step < n; step++) {
+        unsigned int currentVertex = minKeyIndex(key.data(), n);
+        if (key[currentVertex] == constants::INF) break; //Remaining vertices are unreachable
 
-    std::shared_ptr<Vertex> start = findVertex(0);
+        visited[currentVertex] = true;
+        dist[currentVertex] = key[currentVertex];
+        weight += key[currentVertex];
+        key[currentVertex] = constants::INF;
 
-    for (std::shared_ptr<Vertex> &v: vertexSet) {
-        v->setDist(constants::INF);
-        v->setVisited(false);
-        v->setPath(nullptr);
+        distanceMatrix.forEachInRow(currentVertex, [&](unsigned int i, double length) {
+            if (visited[i]) return;
+            length = adjust(currentVertex, i, length);
+            if (length < key[i]) {
+                key[i] = length;
+                parent[i] = currentVertex;
+            }
+        });
     }
-    start->setDist(0);
-    q.insert(start);
+    return weight;
+}
+
+/**
+ * @brief Builds a MST using Prim's algorithm with an IndexedHeap over the adjacency lists
+ * Keys are lowered in place, so the heap never holds more than |V| entries (a lazy heap with duplicates measured
+ * about twice as slow, see HeapBenchmark)
+ * Time Complexity: O(|E|log(|V|)) plus O(|V|²) the first time the adjacency lists are built
+ * @param context - Context that receives the tree
+ * @return Total length of the tree
+ */
+double Graph::primSparse(SolveContext &context) const {
+    buildAdjacency();
+    context.prepare(getNumVertex());
+    if (getNumVertex() == 0) return 0;
+    std::vector<bool> &visited = context.visited;
+    std::vector<double> &dist = context.dist;
+    std::vector<unsigned int> &parent = context.parent;
+    //Indexed heap of the vertices reached so far, kept in the context so its memory is reused between runs;
+    //a shorter edge lowers a vertex's key in place, so every vertex is extracted exactly once
+    IndexedHeap<4> &q = context.heap;
+    q.reset(getNumVertex());
+
+    double weight = 0;
+    dist[0] = 0;
+    q.insert(0, 0);
 
     while (!q.empty()) {
-        //extrai no mais perto da mst, marca-o como visitado e guarda a edge
-        std::shared_ptr<Vertex> currentVertex = q.extractMin();
-        if (currentVertex->getPath() != nullptr) {
-            selectedEdges[currentVertex->getId()][currentVertex->getPath()->getId()] = true;
-            selectedEdges[currentVertex->getPath()->getId()][currentVertex->getId()] = true;
-        }
-        currentVertex->setVisited(true);
-
-        //procura vizinho por visitar
-        for (size_t i = 0; i < vertexSet.size(); i++) {
-            if (distanceMatrix[currentVertex->getId()][i] == constants::INF || i == currentVertex->getId()) continue;
-            std::shared_ptr<Vertex> dest = findVertex(i);
-            if (!dest->isVisited()) {
-                //atualiza dados
-                double oldDist = dest->getDist();
-                if (distanceMatrix[currentVertex->getId()][i] < oldDist) {
-                    dest->setPath(currentVertex);
-                    dest->setDist(distanceMatrix[currentVertex->getId()][i]);
-                    oldDist == constants::INF ? q.insert(dest) : q.decreaseKey(dest);
+        unsigned int currentVertex = q.extractMin();
+        visited[currentVertex] = true;
+        weight += dist[currentVertex];
+
+        for (unsigned int e = adjacencyOffsets[currentVertex]; e < adjacencyOffsets[currentVertex + 1]; e++) {
+            unsigned int i = adjacencyTargets[e];
+            if (!visited[i] && adjacencyLengths[e] < dist[i]) {
+                parent[i] = currentVertex;
+                dist[i] = adjacencyLengths[e];
+                q.insertOrDecrease(i, adjacencyLengths[e]);
+            }
+        }
+    }
+    return weight;
+}
+
+/**
+ * Whether edge (u1, v1) with length l1 comes before edge (u2, v2) with length l2, breaking ties by the edge's ids
+ * Ties must be broken the same way everywhere so that Borůvka never adds a cycle
+ */
+static bool lighterEdge(double l1, unsigned int u1, unsigned int v1, double l2, unsigned int u2, unsigned int v2) {
+    if (l1 != l2) return l1 < l2;
+    std::pair<unsigned int, unsigned int> e1 = std::minmax(u1, v1), e2 = std::minmax(u2, v2);
+    return e1 < e2;
+}
+
+/**
+ * @brief Builds a MST rooted at vertex 0 using Borůvka's algorithm, scanning for cheapest edges in parallel
+ * In each round every vertex looks for its cheapest edge leaving its component (in parallel, rescanning only the
+ * vertices whose previous choice has since been absorbed into their component), then each component keeps its
+ * cheapest edge and the components are merged in parallel with a ConcurrentUFDS
+ * Each vertex's parent in the tree is stored in the context's parent and the length of the edge to it in dist,
+ * as in prim
+ * Time Complexity: O(|V|² log(|V|) / threads) (worst case)
+ * @param context - Context that receives the tree
+ * @param threads - Number of threads to use (0 for one per hardware thread)
+ * @return Total length of the tree
+ */
+double Graph::boruvka(SolveContext &context, unsigned int threads) const {
+    instrumentation::Scope phase(instrumentation::Phase::MST);
+    unsigned int n = getNumVertex();
+    bool sparse = (double) totalEdges * std::log2(std::max(n, 2u)) < (double) n * n;
+    return boruvkaTree(context, threads, 0, sparse, [](unsigned int, unsigned int, double length) { return length; });
+}
+
+/**
+ * Borůvka's algorithm over adjusted edge lengths (see boruvka)
+ * Time Complexity: O(|V|² log(|V|) / threads) (worst case)
+ * @param context - Context that receives the tree
+ * @param threads - Number of threads to use (0 for one per hardware thread)
+ * @param root - Vertex the tree is rooted at
+ * @param sparse - Whether to scan the adjacency lists instead of the rows of the distance matrix
+ *                 (missing edges are then never passed to adjust)
+ * @param adjust - Callable adjust(v, i, length) giving the length to use for the stored edge (v, i)
+ *                 (constants::INF leaves the edge out)
+ * @return Total adjusted length of the part of the tree reachable from the root
+ */
+template<typename Adjust>
+double Graph::boruvkaTree(SolveContext &context, unsigned int threads, unsigned int root, bool sparse,
+                          Adjust adjust) const {
+    unsigned int n = getNumVertex();
+    context.prepare(n);
+    if (n == 0) return 0;
+    if (sparse) buildAdjacency();
+
+    ConcurrentUFDS sets(n);
+    std::vector<std::vector<std::tuple<unsigned int, unsigned int, double>>> merged(parallel::threadCount(threads));
+    std::vector<unsigned int> component(n), bestTarget(n, constants::NO_VERTEX), componentBest(n);
+    std::vector<double> bestLength(n, constants::INF);
+    std::vector<std::tuple<unsigned int, unsigned int, double>> treeEdges;
+    for (unsigned int v = 0; v < n; v++) component[v] = v;
+    //The cheapest edges leaving each vertex's component when it was last scanned, sorted, in [next, count)
+    //(a full, exhausted cache forces the first scan)
+    const unsigned int CACHED = BORUVKA_CACHED_EDGES;
+    std::vector<std::pair<double, unsigned int>> cheapest((size_t) n * CACHED);
+    std::vector<unsigned int> cheapestCount(n, CACHED), cheapestNext(n, CACHED);
+
+    while (treeEdges.size() < n - 1) {
+        //Cheapest edge from every vertex to another component
+        parallel::forBlocks(n, threads, [&](unsigned int first, unsigned int last, unsigned int) {
+            for (unsigned int v = first; v < last; v++) {
+                //A previous choice that still leaves the component is still the cheapest one
+                if (bestTarget[v] != constants::NO_VERTEX && component[bestTarget[v]] != component[v]) continue;
+
+                //Components only grow, so cached edges now inside the component are dropped for good, and every
+                //uncached edge is heavier than the cached ones: the first cached edge left is the cheapest
+                std::pair<double, unsigned int> *cached = cheapest.data() + (size_t) v * CACHED;
+                unsigned int &next = cheapestNext[v], &count = cheapestCount[v];
+                while (next < count && component[cached[next].second] == component[v]) next++;
+                if (next == CACHED) { //Edges may have been left out of the cache, so the vertex is scanned again
+                    next = count = 0;
+                    auto consider = [&](unsigned int i, double l) {
+                        if (component[i] == component[v]) return;
+                        l = adjust(v, i, l);
+                        if (l == constants::INF) return;
+                        if (count == CACHED &&
+                            !lighterEdge(l, v, i, cached[CACHED - 1].first, v, cached[CACHED - 1].second)) return;
+                        unsigned int c = count < CACHED ? count++ : CACHED - 1;
+                        for (; c > 0 && lighterEdge(l, v, i, cached[c - 1].first, v, cached[c - 1].second); c--)
+                            cached[c] = cached[c - 1];
+                        cached[c] = {l, i};
+                    };
+                    if (sparse) {
+                        for (unsigned int e = adjacencyOffsets[v]; e < adjacencyOffsets[v + 1]; e++)
+                            consider(adjacencyTargets[e], adjacencyLengths[e]);
+                    } else distanceMatrix.forEachInRow(v, consider);
                 }
+                bestTarget[v] = next < count ? cached[next].second : constants::NO_VERTEX;
+                bestLength[v] = next < count ? cached[next].first : constants::INF;
             }
+        });
+
+        //Cheapest edge leaving every component
+        for (unsigned int v = 0; v < n; v++) componentBest[component[v]] = constants::NO_VERTEX;
+        for (unsigned int v = 0; v < n; v++) {
+            if (bestTarget[v] == constants::NO_VERTEX) continue;
+            unsigned int &best = componentBest[component[v]];
+            if (best == constants::NO_VERTEX ||
+                lighterEdge(bestLength[v], v, bestTarget[v], bestLength[best], best, bestTarget[best]))
+                best = v;
+        }
+
+        //The chosen edges form a forest (two components may pick the same edge, which only one link accepts)
+        parallel::forBlocks(n, threads, [&](unsigned int first, unsigned int last, unsigned int t) {
+            for (unsigned int c = first; c < last; c++) {
+                unsigned int v = componentBest[c];
+                if (component[c] != c || v == constants::NO_VERTEX) continue;
+                if (sets.linkSets(v, bestTarget[v])) merged[t].emplace_back(v, bestTarget[v], bestLength[v]);
+            }
+        });
+        size_t edgesBefore = treeEdges.size();
+        for (auto &edges: merged) {
+            treeEdges.insert(treeEdges.end(), edges.begin(), edges.end());
+            edges.clear();
+        }
+        if (treeEdges.size() == edgesBefore) break; //Remaining components are unreachable
+
+        parallel::forBlocks(n, threads, [&](unsigned int first, unsigned int last, unsigned int) {
+            for (unsigned int v = first; v < last; v++) component[v] = sets.findSet(v);
+        });
+    }
+
+    return rootTree(treeEdges, context, root);
+}
+
+/**
+ * Stores a spanning tree given by its edges in the context's parent and dist
+ * Time Complexity: O(|V|)
+ * @param treeEdges - Edges of the tree, as (vertex, vertex, length)
+ * @param context - Context that receives the tree (its per-vertex state must have just been prepared)
+ * @param root - Vertex the tree is rooted at
+ * @return Total length of the part of the tree reachable from the root
+ */
+double Graph::rootTree(const std::vector<std::tuple<unsigned int, unsigned int, double>> &treeEdges,
+                       SolveContext &context, unsigned int root) const {
+    unsigned int n = getNumVertex();
+    std::vector<bool> &visited = context.visited;
+    std::vector<double> &dist = context.dist;
+    std::vector<unsigned int> &parent = context.parent;
+    std::vector<unsigned int> offsets(n + 1, 0), neighbours(2 * treeEdges.size());
+    for (auto &[u, v, length]: treeEdges) offsets[u + 1]++, offsets[v + 1]++;
+    for (unsigned int i = 0; i < n; i++) offsets[i + 1] += offsets[i];
+    std::vector<unsigned int> next(offsets.begin(), offsets.end() - 1);
+    for (unsigned int e = 0; e < treeEdges.size(); e++) {
+        auto &[u, v, length] = treeEdges[e];
+        neighbours[next[u]++] = e;
+        neighbours[next[v]++] = e;
+    }
+
+    double weight = 0;
+    std::vector<unsigned int> stack = {root};
+    visited[root] = true;
+    dist[root] = 0;
+    while (!stack.empty()) {
+        unsigned int u = stack.back();
+        stack.pop_back();
+        for (unsigned int k = offsets[u]; k < offsets[u + 1]; k++) {
+            auto &[a, b, length] = treeEdges[neighbours[k]];
+            unsigned int v = a == u ? b : a;
+            if (visited[v]) continue;
+            visited[v] = true;
+            parent[v] = u;
+            dist[v] = length;
+            weight += length;
+            stack.push_back(v);
         }
     }
+    return weight;
+}
+
+/**
+ * Builds the adjacency lists of the graph (in CSR form) from the distance matrix, if they are outdated
+ * Safe to call from concurrent solver runs: the first caller builds the lists while the others wait for it
+ * Time Complexity: O(|V|²)
+ */
+void Graph::buildAdjacency() const {
+    if (adjacencyValid.load(std::memory_order_acquire)) return;
+    std::lock_guard<std::mutex> lock(adjacencyMutex);
+    if (adjacencyValid.load(std::memory_order_relaxed)) return;
+    unsigned int n = getNumVertex();
+
+    std::vector<unsigned int> degree(n + 1, 0);
+    distanceMatrix.forEachEntry([&degree](unsigned int i, unsigned int j, double length) {
+        if (length == constants::INF) return;
+        degree[i]++;
+        degree[j]++;
+    });
+    adjacencyOffsets.assign(n + 1, 0);
+    for (unsigned int v = 0; v < n; v++) adjacencyOffsets[v + 1] = adjacencyOffsets[v] + degree[v];
+
+    adjacencyTargets.resize(adjacencyOffsets[n]);
+    adjacencyLengths.resize(adjacencyOffsets[n]);
+    std::vector<unsigned int> next(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    distanceMatrix.forEachEntry([&](unsigned int i, unsigned int j, double length) {
+        if (length == constants::INF) return;
+        adjacencyTargets[next[i]] = j;
+        adjacencyLengths[next[i]++] = length;
+        adjacencyTargets[next[j]] = i;
+        adjacencyLengths[next[j]++] = length;
+    });
+    adjacencyValid.store(true, std::memory_order_release);
 }
 
 /**
- * Adds a vertex to the tour structure and updates the total distance
+ * Adds a vertex to the end of a tour and updates its length
  * Time Complexity: O(1)
+ * @param tour - Tour being built
  * @param stop - Vertex to add
  * @return execution errors (0 if none, -1 if couldn't calculate Edge length, -2 if self-loop)
  */
-int Graph::addToTour(const std::shared_ptr<Vertex> &stop) {
-    if (!tour.course.empty()) {
-        if ((*(tour.course).rbegin())->getId() == stop->getId()) {
-            //selfloop
-            return -2;
-        }
-        double aresta = findEdge((*(tour.course).rbegin()), stop);
-        if (aresta == -1) {
-            //rejeitar tour
+int Graph::addToTour(Tour &tour, const unsigned int &stop) const {
+    double aresta = 0;
+    if (!tour.empty()) {
+        aresta = findEdge(tour[tour.size() - 1], stop);
+        if (aresta < 0) {
+            //rejeitar tour (-2 if selfloop)
             return (int) aresta;
         }
-        tour.distance += aresta;
     }
-    tour.course.push_back(stop);
+    tour.append(stop, aresta);
     return 0;
 }
 
 /**
- * @brief Iterates through the vertex set using DFS, respecting if an edge is selected or not
- * Time Complexity: O(|V|²)
- * @param source - Vertex where the DFS starts
+ * @brief Iterates through the vertex set using DFS, following the edges of the MST stored in parent
+ * The children of every vertex are gathered into compact lists (CSR form) and walked with an explicit stack,
+ * so the traversal is linear and doesn't recurse; children are visited by increasing id
+ * Time Complexity: O(|V|)
+ * @param source - Vertex where the DFS starts (the root of the MST)
+ * @param tour - Tour the vertices are appended to, closed back at the source at the end
+ * @param context - Context holding the tree, whose visited marks must be cleared
  * @return execution errors (0 if none, -1 if couldn't calculate Edge length, -2 if self-loop)
  */
-int Graph::preorderMSTTraversal(const std::shared_ptr<Vertex> &source) {
-    source->setVisited(true);
-    int exec_val = addToTour(source);
-    if (exec_val != 0) return exec_val;
-
-    for (size_t i = 0; i < vertexSet.size(); i++) {
-        std::shared_ptr<Vertex> dest = findVertex(i);
+int Graph::preorderMSTTraversal(const unsigned int &source, Tour &tour, SolveContext &context) const {
+    unsigned int n = getNumVertex();
+    std::vector<bool> &visited = context.visited;
+    std::vector<unsigned int> &parent = context.parent;
+    std::vector<unsigned int> &childOffsets = context.childOffsets;
+    std::vector<unsigned int> &children = context.children;
+    std::vector<unsigned int> &stack = context.stack;
+    //The children of v are children[childOffsets[v]..childOffsets[v + 1]); counting into v + 2 lets the fill
+    //below advance each start into the next one's
+    childOffsets.assign(n + 2, 0);
+    children.resize(n);
+    for (unsigned int v = 0; v < n; v++)
+        if (parent[v] != constants::NO_VERTEX) childOffsets[parent[v] + 2]++;
+    for (unsigned int v = 0; v < n; v++) childOffsets[v + 2] += childOffsets[v + 1];
+    for (unsigned int v = 0; v < n; v++)
+        if (parent[v] != constants::NO_VERTEX) children[childOffsets[parent[v] + 1]++] = v;
 
-        if (!(dest->isVisited()) && selectedEdges[source->getId()][i]) {
-            preorderMSTTraversal(dest);
-        }
+    tour.reserve(n);
+    stack.clear();
+    stack.push_back(source);
+    while (!stack.empty()) {
+        unsigned int current = stack.back();
+        stack.pop_back();
+        visited[current] = true;
+        int exec_val = addToTour(tour, current);
+        if (exec_val != 0) return exec_val;
+        //Pushed in reverse, so the child with the smallest id is visited first
+        for (unsigned int e = childOffsets[current + 1]; e > childOffsets[current]; e--)
+            if (!visited[children[e - 1]]) stack.push_back(children[e - 1]);
     }
 
-    if (source->getId() == 0) return addToTour(source);
+    //The cycle closes back at the source, which isn't stored twice
+    double closing = findEdge(tour[tour.size() - 1], source);
+    if (closing < 0) return (int) closing;
+    tour.setLength(tour.getLength() + closing);
     return 0;
 }
 
 /**
  * Calculates an approximation of the TSP, using the triangular approximation heuristic
  * Time Complexity: O(|V|²)
+ * @return The tour found (empty, with infinite length, if the preorder can't be closed into a tour)
+ */
+Tour Graph::triangularTSPTour() const {
+    SolveContextPool::Lease context = contexts.acquire();
+    return triangularTSPTour(*context);
+}
+
+/**
+ * Calculates an approximation of the TSP, using the triangular approximation heuristic
+ * Time Complexity: O(|V|²)
+ * @param context - Context holding the scratch state of this run
+ * @return The tour found (empty, with infinite length, if the preorder can't be closed into a tour)
  */
-void Graph::triangularTSPTour() {
+Tour Graph::triangularTSPTour(SolveContext &context) const {
     /*
     -Build MST
     -Get pre-order of the mst as vector
     -Iterate that order getting total dist
     */
-    tour = {0, {}};
-    prim();
+    Tour tour(getNumVertex());
+    threadCount > 1 ? boruvka(context, threadCount) : prim(context);
 
-    for (std::shared_ptr<Vertex> &v: vertexSet) v->setVisited(false);
+    std::fill(context.visited.begin(), context.visited.end(), false);
 
-    int exec_val = preorderMSTTraversal(findVertex(0));
-    switch (exec_val) {
-        case -1:
-            printf("Couldn't calculate approximation of TSP for this graph!\n");
-            break;
-        case -2:
-            printf("Course would contain self-loop!\n");
-            break;
-        default:
-            break;
+    instrumentation::Scope phase(instrumentation::Phase::TRAVERSAL);
+    int exec_val = preorderMSTTraversal(0, tour, context);
+    //A partial preorder isn't a tour, so it must not look like one; callers report the failure (the command line
+    //keeps stdout for its records)
+    if (exec_val != 0) {
+        tour.clear();
+        tour.setLength(constants::INF);
     }
 
-    //results are updated in tour
+    return tour;
 }
 
 /**
- * Displays tour's Vertices by order
+ * Displays tour's Vertices by order, returning to the first one at the end
  * Time Complexity: O(|V|)
+ * @param tour - Tour to display
  */
-void Graph::printTour() {
-    printf("Path taken: ");
-    for (const std::shared_ptr<Vertex> &v: tour.course) {
-        printf(" %d", v->getId());
-    }
-    printf("\n");
-}
-
-/**
- * Displays tour's Vertices by order
- * @param tour - Vector containing the ordered tour vertices
- */
-void Graph::printTour(const std::vector<unsigned int> &tour) {
+void Graph::printTour(const Tour &tour) const {
     printf("Path taken: ");
     for (const unsigned int &v: tour) {
-        printf(" %d", v);
-    }
-    printf("\n");
-}
-
-/**
- * Displays tour's Vertices by order
- * @param tour - Array containing the ordered tour vertices
- */
-void Graph::printTour(unsigned int *tour) {
-    printf("Path taken: ");
-    for (int i = 0; i < vertexSet.size(); i++) {
-        printf(" %d", tour[i]);
+        printf(" %u", getExternalId(v));
     }
+    if (!tour.empty()) printf(" %u", getExternalId(tour[0]));
     printf("\n");
 }
 
 bool Graph::inSolution(unsigned int j, const std::vector<unsigned int> &solution, unsigned int n) {
-    for (int i = 0; i < n; i++) {
+    for (unsigned int i = 0; i < n; i++) {
         if (solution[i] == j) {
             return true;
         }
@@ -265,148 +578,1064 @@ bool Graph::inSolution(unsigned int j, const std::vector<unsigned int> &solution
 /**
  * A backtracking function for the Travelling Salesperson Problem, which looks for the hamiltonian cycle with the smallest length possible
  * Time Complexity: O(N!) (worst case)
- * @return The weight of the smallest path obtainable
+ * @return The shortest tour (empty, with infinite length, if there is none)
+ */
+Tour Graph::tspBT() const {
+    SolveContextPool::Lease context = contexts.acquire();
+    return tspBT(*context);
+}
+
+/**
+ * A backtracking function for the Travelling Salesperson Problem, which looks for the hamiltonian cycle with the smallest length possible
+ * With a shared incumbent, the search also prunes with the best tour other solvers found, offers every improvement
+ * to them, stops when the incumbent expires and, if it finishes, proves the incumbent optimal when it is a closed
+ * tour over stored edges
+ * Time Complexity: O(N!) (worst case)
+ * @param context - Context holding the scratch state of this run
+ * @param shared - Best tour shared with other solvers, or nullptr for a standalone search
+ * @return The shortest tour found (empty, with infinite length, if there is none)
  */
-std::pair<double, std::vector<unsigned int>> Graph::tspBT() {
-    unsigned int n = this->vertexSet.size();
-    std::vector<unsigned int> currentSolution(n + 1);
-    std::vector<unsigned int> path(n + 1);
-    currentSolution[0] = 0;
+Tour Graph::tspBT(SolveContext &context, Incumbent *shared) const {
+    instrumentation::Scope phase(instrumentation::Phase::BACKTRACKING);
+    unsigned int n = this->getNumVertex();
+    context.path.assign(n + 1, 0);
+    context.bestPath.assign(n + 1, 0);
+    context.steps = 0;
     double bestSolutionDist = constants::INF;
-    tspRecursion(currentSolution, 0, 1, bestSolutionDist, path, n);
-    path[n] = 0;
-    return {bestSolutionDist, path};
+    bool finished = tspRecursion(context, 0, 1, bestSolutionDist, n, shared);
+    //A finished search only proves that no tour beats the incumbent, so the incumbent must be a tour itself: every
+    //stop, closed over stored edges (other engines may have offered tours over estimated edges, or none at all)
+    if (shared != nullptr && finished) {
+        Tour best = shared->getTour();
+        bool closed = best.size() == n && n > 0;
+        for (unsigned int i = 0; closed && n > 1 && i < n; i++)
+            closed = distanceMatrix.get(best[i], best[best.next(i)]) != constants::INF;
+        if (closed) shared->proveOptimal();
+    }
+
+    Tour tour(n);
+    if (bestSolutionDist != constants::INF)
+        for (unsigned int i = 0; i < n; i++) tour.append(context.bestPath[i], 0);
+    tour.setLength(bestSolutionDist);
+    return tour;
 }
 
 
 /**
  * Recursive function for tspBT
+ * The path taken so far is in context.path and the best one found in context.bestPath
  * Time Complexity: O(N!) (worst case)
- * @param currentSolution - Vector of the path taken so far
+ * @param context - Context holding the paths
  * @param currentSolutionDist - Weight of the path taken so far
  * @param currentNodeIdx - Id of the node the algorithm is currently on
  * @param bestSolutionDist - Weight of the best path obtained so far
- * @param bestSolution - Vector of the best path obtained so far
  * @param n - Number of nodes in the graph
+ * @param shared - Best tour shared with other solvers, or nullptr
+ * @return false if the search was stopped because the shared incumbent expired
  */
-void
-Graph::tspRecursion(std::vector<unsigned int> &currentSolution, double currentSolutionDist,
-                    unsigned int currentNodeIdx,
-                    double &bestSolutionDist, std::vector<unsigned int> &bestSolution, unsigned int n) {
+bool Graph::tspRecursion(SolveContext &context, double currentSolutionDist, unsigned int currentNodeIdx,
+                         double &bestSolutionDist, unsigned int n, Incumbent *shared) const {
+    std::vector<unsigned int> &currentSolution = context.path;
+    instrumentation::count(instrumentation::Counter::SEARCH_NODES);
+    //Checking the clock is slower than a search step, so steps are charged to the incumbent a few thousand at a time
+    if (shared != nullptr && (++context.steps & 4095) == 0 && !shared->charge(4096)) return false;
+
     if (currentNodeIdx == n) {
         //Could need to verify here if last node connects to first
-        if (this->distanceMatrix[currentSolution[currentNodeIdx - 1]][0] != constants::INF) {
+        double closingLength = this->distanceMatrix.get(currentSolution[currentNodeIdx - 1], 0);
+        if (closingLength != constants::INF) {
             //Add dist from last node back to zero and check if it's an improvement
-            if (currentSolutionDist + this->distanceMatrix[currentSolution[currentNodeIdx - 1]][0] < bestSolutionDist) {
-                bestSolutionDist = currentSolutionDist + this->distanceMatrix[currentSolution[currentNodeIdx - 1]][0];
-                for (int i = 0; i < n; i++) {
-                    bestSolution[i] = currentSolution[i];
+            if (currentSolutionDist + closingLength < bestSolutionDist) {
+                bestSolutionDist = currentSolutionDist + closingLength;
+                for (unsigned int i = 0; i < n; i++) {
+                    context.bestPath[i] = currentSolution[i];
+                }
+                if (shared != nullptr) {
+                    Tour tour(n);
+                    for (unsigned int i = 0; i < n; i++) tour.append(currentSolution[i], 0);
+                    tour.setLength(bestSolutionDist);
+                    shared->offer(tour, "backtracking");
                 }
             }
         }
-        return;
+        return true;
 
     }
     //Check if node is already in path
-    for (int i = 1; i < n; i++) {
-        if (i == 12) {
-            int a = 1;
-        }
-        if (this->distanceMatrix[currentSolution[currentNodeIdx - 1]].size() > i &&
-            this->distanceMatrix[currentSolution[currentNodeIdx - 1]][i] + currentSolutionDist < bestSolutionDist) {
+    for (unsigned int i = 1; i < n; i++) {
+        double bound = shared != nullptr ? std::min(bestSolutionDist, shared->getLength()) : bestSolutionDist;
+        double length = this->distanceMatrix.get(currentSolution[currentNodeIdx - 1], i);
+        if (length + currentSolutionDist < bound) {
             if (!inSolution(i, currentSolution, currentNodeIdx)) {
                 currentSolution[currentNodeIdx] = i;
-                tspRecursion(currentSolution,
-                             this->distanceMatrix[currentSolution[currentNodeIdx - 1]][i] + currentSolutionDist,
-                             currentNodeIdx + 1, bestSolutionDist, bestSolution, n);
+                if (!tspRecursion(context, length + currentSolutionDist, currentNodeIdx + 1, bestSolutionDist, n,
+                                  shared))
+                    return false;
+            }
+        } else {
+            instrumentation::count(instrumentation::Counter::SEARCH_PRUNED);
+        }
+    }
+    return true;
+}
+
+/**
+ * Runs the nearest insertion heuristic from one start vertex after another, offering every tour to an incumbent,
+ * until every start was tried or the incumbent expires (each run is one iteration)
+ * Time Complexity: O(|V|³) (worst case)
+ * @param incumbent - Best tour shared with other solvers
+ * @param context - Context holding the scratch state of this run
+ */
+void Graph::nearestInsertionSearch(Incumbent &incumbent, SolveContext &context) const {
+    for (unsigned int start = 0; start < getNumVertex() && !incumbent.expired(); start++) {
+        incumbent.offer(nearestInsertionHeuristic(start, context),
+                        "nearest insertion from " + std::to_string(getExternalId(start)));
+        incumbent.charge();
+    }
+}
+
+/**
+ * Races several solvers on this graph, sharing the best tour found so far, until the incumbent expires
+ * The engines run in parallel, each with its own context:
+ * - the triangular approximation (run once, as one iteration)
+ * - the nearest insertion heuristic, from one start vertex after another
+ * - simulated annealing, with its default options
+ * - backtracking, when the graph has at most EXACT_PORTFOLIO_LIMIT vertices, pruning with the shared tour
+ * If backtracking finishes, the tour is optimal and the other engines stop early
+ * The incumbent is checked between nearest insertion runs, during annealing and during backtracking; the triangular
+ * approximation always runs to the end, so the call may return after the deadline on large graphs
+ * Annealing only stops when the incumbent expires, so without a budget the search runs until it is stopped
+ * Time Complexity: O(budget + |V|²)
+ * @param incumbent - Best tour shared by the engines, which also says when to stop
+ */
+void Graph::portfolioSearch(Incumbent &incumbent) const {
+    std::vector<std::jthread> engines;
+    engines.emplace_back([&] {
+        SolveContextPool::Lease context = contexts.acquire();
+        incumbent.offer(triangularTSPTour(*context), "triangular approximation");
+        incumbent.charge();
+    });
+    engines.emplace_back([&] {
+        SolveContextPool::Lease context = contexts.acquire();
+        nearestInsertionSearch(incumbent, *context);
+    });
+    engines.emplace_back([&] {
+        annealingSearch(incumbent, annealing_t());
+    });
+    if (getNumVertex() <= EXACT_PORTFOLIO_LIMIT) {
+        engines.emplace_back([&] {
+            SolveContextPool::Lease context = contexts.acquire();
+            tspBT(*context, &incumbent);
+        });
+    }
+}
+
+/**
+ * Races several solvers on this graph until a deadline and keeps the shortest tour any of them finds
+ * (see portfolioSearch)
+ * Time Complexity: O(budget + |V|²)
+ * @param budget - Time allowed for the search
+ * @return The best tour, the name of the engine that found it and whether it is known to be optimal
+ */
+Graph::portfolio_t Graph::portfolioTSPTour(std::chrono::milliseconds budget) const {
+    Incumbent incumbent(std::chrono::steady_clock::now() + budget);
+    portfolioSearch(incumbent);
+    return {incumbent.getTour(), incumbent.getEngine(), incumbent.isOptimal()};
+}
+
+/**
+ * @brief Improves tours by simulated annealing, in independent chains running in parallel, until the incumbent expires
+ * Each chain starts from the nearest insertion tour of a random vertex and repeatedly proposes a random move that
+ * joins a random vertex to one of its nearest neighbours: a 2-opt move, or an or-opt move of the segment of up to
+ * three vertices starting at it; shorter tours are always accepted and longer ones with probability
+ * e^(-increase / temperature)
+ * The starting temperature accepts an average increase with the given probability; it then follows the chosen
+ * cooling schedule over the time or iteration budget (each proposed move is an iteration, charged a thousand at a time)
+ * Chains offer their tour to the incumbent whenever it beats it
+ * Time Complexity: O(budget + |V|²)
+ * @param incumbent - Best tour shared with other solvers, which also says when to stop
+ * @param options - Schedule, number of chains and neighbourhood size
+ */
+void Graph::annealingSearch(Incumbent &incumbent, const annealing_t &options) const {
+    instrumentation::Scope phase(instrumentation::Phase::ANNEALING);
+    unsigned int n = getNumVertex();
+    if (n < 5) { //Too few vertices for the moves to change anything
+        incumbent.offer(nearestInsertionHeuristic(0), "simulated annealing");
+        incumbent.charge();
+        return;
+    }
+    std::vector<unsigned int> storage;
+    neighbours_t neighbours = neighbourLists(options.candidates, storage);
+    uint64_t seed = options.seed != 0 ? options.seed : Xoshiro256::local()();
+    unsigned int chains = parallel::threadCount(options.chains != 0 ? options.chains : threadCount);
+    parallel::forBlocks(chains, chains, [&](unsigned int first, unsigned int last, unsigned int) {
+        SolveContextPool::Lease context = contexts.acquire();
+        for (unsigned int chain = first; chain < last; chain++)
+            annealChain(incumbent, options, neighbours, Xoshiro256(seed + chain), *context);
+    });
+}
+
+/**
+ * Runs one simulated annealing chain (see annealingSearch)
+ * Time Complexity: O(budget + |V|²)
+ * @param incumbent - Best tour shared with other solvers, which also says when to stop
+ * @param options - Schedule and its parameters
+ * @param neighbours - Nearest neighbours of each vertex (see neighbourLists)
+ * @param generator - Random generator of this chain
+ * @param context - Context holding the scratch state of this run
+ */
+void Graph::annealChain(Incumbent &incumbent, const annealing_t &options, const neighbours_t &neighbours,
+                        Xoshiro256 generator, SolveContext &context) const {
+    unsigned int n = getNumVertex();
+    auto length = [this](unsigned int a, unsigned int b) { return findEdge(a, b); };
+    Tour tour = nearestInsertionHeuristic(generator.below(n), context);
+    tour.computeLength(length);
+    incumbent.offer(tour, "simulated annealing");
+
+    //Picks a random move and computes its change in length, in O(1); false if the move would change nothing
+    unsigned int i, j, at;
+    bool twoOpt, reversed;
+    auto propose = [&](double &delta) {
+        i = generator.below(n);
+        unsigned int neighbour = neighbours.of(tour[i])[generator.below(neighbours.k)];
+        unsigned int p = tour.positionOf(neighbour);
+        twoOpt = generator.below(2) == 0;
+        if (twoOpt) { //Reverse what lies between the two vertices, so that they become adjacent
+            unsigned int low = std::min(i, p), high = std::max(i, p);
+            if (high - low < 2) return false;
+            i = low + 1;
+            j = high;
+            delta = tour.twoOptDelta(i, j, length);
+        } else { //Move the segment that starts at the vertex to beside the neighbour, on either side
+            j = i + generator.below(3);
+            at = generator.below(2) == 0 ? p : tour.previous(p);
+            reversed = generator.below(2) == 0;
+            if (j >= n || (at >= i && at <= j) || at == tour.previous(i)) return false;
+            delta = tour.orOptDelta(i, j, at, reversed, length);
+        }
+        return true;
+    };
+
+    //Starting temperature, from the increases of a sample of moves
+    double increases = 0;
+    unsigned int uphill = 0;
+    for (unsigned int sample = 0; sample < ANNEALING_SAMPLE; sample++) {
+        double delta;
+        if (propose(delta) && delta > 0) increases += delta, uphill++;
+    }
+    if (uphill == 0) return; //No move makes the tour longer, so there is nothing to escape from
+    double initialTemperature = -(increases / uphill) / std::log(options.initialAcceptance);
+    double temperature = initialTemperature, acceptance = options.initialAcceptance, target = acceptance;
+    double bestLength = tour.getLength();
+
+    for (unsigned long moves = 0;; moves++) {
+        if (moves % ANNEALING_EPOCH == 0 && moves != 0) {
+            if (!incumbent.charge(ANNEALING_EPOCH)) break;
+            //The cached length drifts with rounding, so it is recomputed before being compared
+            if (tour.getLength() < bestLength && tour.computeLength(length) < bestLength) {
+                bestLength = tour.getLength();
+                incumbent.offer(tour, "simulated annealing");
+            }
+            //Without a budget, the schedule starts over every ANNEALING_CYCLE moves per vertex
+            double progress = incumbent.getProgress();
+            if (progress < 0) progress = (double) (moves % ((unsigned long) ANNEALING_CYCLE * n)) / ANNEALING_CYCLE / n;
+            if (options.cooling == annealing_t::Cooling::EXPONENTIAL)
+                temperature = initialTemperature * std::pow(options.finalTemperature, progress);
+            else if (progress < 0.15) target = 0.44 + 0.56 * std::pow(560, -progress / 0.15);
+            else if (progress < 0.65) target = 0.44;
+            else target = 0.44 * std::pow(440, -(progress - 0.65) / 0.35);
+        }
+
+        double delta;
+        if (!propose(delta)) continue;
+        bool accepted = delta <= 0 || generator.uniform() < std::exp(-delta / temperature);
+        if (accepted) {
+            if (twoOpt) tour.twoOpt(i, j, delta);
+            else tour.orOpt(i, j, at, reversed, delta);
+        }
+        if (options.cooling == annealing_t::Cooling::LAM) {
+            //Cools while more moves are accepted than the schedule expects, and warms up otherwise
+            acceptance = 0.998 * acceptance + (accepted ? 0.002 : 0);
+            temperature *= acceptance > target ? 0.999 : 1 / 0.999;
+        }
+    }
+    if (tour.computeLength(length) < bestLength) incumbent.offer(tour, "simulated annealing");
+}
+
+/**
+ * Improves tours by simulated annealing until a deadline, with the default options (see annealingSearch)
+ * Time Complexity: O(budget + |V|²)
+ * @param budget - Time allowed for the search
+ * @return The shortest tour found by any chain
+ */
+Tour Graph::simulatedAnnealing(std::chrono::milliseconds budget) const {
+    return simulatedAnnealing(budget, annealing_t());
+}
+
+/**
+ * Improves tours by simulated annealing until a deadline (see annealingSearch)
+ * Time Complexity: O(budget + |V|²)
+ * @param budget - Time allowed for the search
+ * @param options - Schedule, number of chains and neighbourhood size
+ * @return The shortest tour found by any chain
+ */
+Tour Graph::simulatedAnnealing(std::chrono::milliseconds budget, const annealing_t &options) const {
+    Incumbent incumbent(std::chrono::steady_clock::now() + budget);
+    annealingSearch(incumbent, options);
+    return incumbent.getTour();
+}
+
+/**
+ * Applies improving 2-opt moves that join a vertex to one of its nearest neighbours until none is left
+ * Vertices whose surroundings haven't changed since they were last checked are skipped, and the neighbours of a
+ * vertex are tried nearest first, stopping once they are farther than the vertex's own tour neighbour
+ * Time Complexity: O(moves * (k + |V|)) (each move reverses up to half of the tour)
+ * @param tour - Tour to improve
+ * @param neighbours - Nearest neighbours of each vertex, sorted by length (see neighbourLists)
+ * @param context - Context holding the scratch state of this run
+ */
+void Graph::twoOptDescent(Tour &tour, const neighbours_t &neighbours, SolveContext &context) const {
+    unsigned int n = tour.size();
+    if (n < 4) return;
+    auto length = [this](unsigned int a, unsigned int b) { return findEdge(a, b); };
+    std::vector<bool> &queued = context.visited;
+    std::vector<unsigned int> &active = context.stack;
+    queued.assign(getNumVertex(), true);
+    active.assign(tour.begin(), tour.end());
+
+    while (!active.empty()) {
+        unsigned int a = active.back();
+        active.pop_back();
+        queued[a] = false;
+        for (unsigned int c = 0; c < neighbours.k; c++) {
+            unsigned int b = neighbours.of(a)[c];
+            unsigned int i = tour.positionOf(a), p = tour.positionOf(b);
+            if (i == p) continue;
+            double joined = length(a, b);
+            //Joining a and b also joins their successors, or their predecessors; either must remove a longer edge
+            if (joined >= length(a, tour[tour.next(i)]) && joined >= length(a, tour[tour.previous(i)])) break;
+            unsigned int low = std::min(i, p), high = std::max(i, p);
+            double delta = high - low > 1 ? tour.twoOptDelta(low + 1, high, length) : 0;
+            unsigned int first = low + 1, last = high;
+            if (delta >= -IMPROVEMENT_EPSILON && high - low > 1) {
+                delta = tour.twoOptDelta(low, high - 1, length);
+                first = low, last = high - 1;
+            }
+            if (delta >= -IMPROVEMENT_EPSILON) continue;
+
+            //The endpoints of the four edges involved are checked again
+            unsigned int ends[4] = {tour[tour.previous(first)], tour[first], tour[last], tour[tour.next(last)]};
+            tour.twoOpt(first, last, delta);
+            for (unsigned int v: ends) {
+                if (queued[v]) continue;
+                queued[v] = true;
+                active.push_back(v);
+            }
+            break;
+        }
+    }
+}
+
+/**
+ * Order crossover (OX): the child keeps a random slice of the first parent in place and takes the other vertices in
+ * the order they follow the slice in the second parent
+ * Time Complexity: O(|V|)
+ * @param first - Ids of the first parent
+ * @param second - Ids of the second parent
+ * @param child - Receives the ids of the child
+ * @param taken - Scratch marks, one per vertex
+ * @param generator - Random generator for the slice
+ */
+void Graph::orderCrossover(std::span<const unsigned int> first, std::span<const unsigned int> second,
+                           std::span<unsigned int> child, std::vector<bool> &taken, Xoshiro256 &generator) {
+    unsigned int n = (unsigned int) first.size();
+    unsigned int from = generator.below(n), to = generator.below(n);
+    if (from > to) std::swap(from, to);
+    taken.assign(n, false);
+    for (unsigned int i = from; i <= to; i++) {
+        child[i] = first[i];
+        taken[first[i]] = true;
+    }
+    unsigned int at = to + 1 == n ? 0 : to + 1;
+    for (unsigned int i = 0, j = at; i < n; i++, j = j + 1 == n ? 0 : j + 1) {
+        if (taken[second[j]]) continue;
+        child[at] = second[j];
+        at = at + 1 == n ? 0 : at + 1;
+    }
+}
+
+/**
+ * @brief Evolves populations of tours on islands running in parallel, until the incumbent expires
+ * Each island keeps its tours in its part of one TourArena, seeded with the triangular approximation, nearest
+ * insertion tours from random vertices and mutated copies of these
+ * Each generation, two parents picked by binary tournament are combined by order crossover; the child is mutated by
+ * random 2-opt moves, improved by 2-opt descent if asked to, and replaces the longest tour of the island if it is
+ * shorter and its length is not already there
+ * Every few generations each island sends a copy of its best tour to the next one, in a ring
+ * Each generation is an iteration
+ * Time Complexity: O(budget + |V|²)
+ * @param incumbent - Best tour shared with other solvers, which also says when to stop
+ * @param options - Number and size of the islands, migration interval and mutation
+ */
+void Graph::geneticSearch(Incumbent &incumbent, const genetic_t &options) const {
+    instrumentation::Scope phase(instrumentation::Phase::GENETIC);
+    unsigned int n = getNumVertex();
+    if (n < 5) { //Too few vertices for crossover to produce anything new
+        incumbent.offer(nearestInsertionHeuristic(0), "genetic algorithm");
+        incumbent.charge();
+        return;
+    }
+    std::vector<unsigned int> storage;
+    neighbours_t neighbours = neighbourLists(options.candidates, storage);
+    uint64_t seed = options.seed != 0 ? options.seed : Xoshiro256::local()();
+    unsigned int islands = parallel::threadCount(options.islands != 0 ? options.islands : threadCount);
+    unsigned int size = std::max(options.populationSize, 2u);
+    const Tour triangular = triangularTSPTour();
+    incumbent.offer(triangular, "triangular approximation");
+
+    //Each island owns size + 2 tours of the arena: its population, a child and a mailbox for immigrants
+    unsigned int stride = size + 2;
+    TourArena arena(islands * stride, n);
+    std::vector<std::mutex> mailboxes(islands);
+    std::vector<char> delivered(islands, false); // whether each mailbox holds a tour not taken in yet
+
+    parallel::forBlocks(islands, islands, [&](unsigned int firstIsland, unsigned int lastIsland, unsigned int) {
+        SolveContextPool::Lease context = contexts.acquire();
+        auto length = [this](unsigned int a, unsigned int b) { return findEdge(a, b); };
+        std::vector<bool> taken;
+        Tour tour(n);
+        for (unsigned int island = firstIsland; island < lastIsland; island++) {
+            Xoshiro256 generator(seed + island);
+            unsigned int base = island * stride, child = base + size, mailbox = child + 1;
+            std::vector<unsigned int> members(size); // slots of the population, in no particular order
+            for (unsigned int m = 0; m < size; m++) members[m] = base + m;
+
+            auto mutate = [&](unsigned int moves) {
+                for (unsigned int move = 0; move < moves; move++) {
+                    unsigned int i = generator.below(n), j = generator.below(n);
+                    if (i > j) std::swap(i, j);
+                    tour.twoOpt(i, j, tour.twoOptDelta(i, j, length));
+                }
+            };
+            auto improve = [&] {
+                if (options.localSearch) twoOptDescent(tour, neighbours, *context);
+                tour.computeLength(length);
+            };
+            //Puts the child in place of the longest tour if it is shorter and not a copy of a tour already there
+            auto replace = [&](unsigned int slot) {
+                unsigned int worst = 0;
+                for (unsigned int m = 0; m < size; m++) {
+                    if (std::abs(arena.getLength(members[m]) - arena.getLength(slot)) < IMPROVEMENT_EPSILON) return;
+                    if (arena.getLength(members[m]) > arena.getLength(members[worst])) worst = m;
+                }
+                if (arena.getLength(slot) >= arena.getLength(members[worst])) return;
+                if (slot == child) std::swap(members[worst], child); //The old slot becomes the next child
+                else arena.copy(slot, members[worst]);
+            };
+
+            //Seeds: the triangular approximation, a few nearest insertion tours, then mutated copies of those
+            for (unsigned int m = 0; m < size; m++) {
+                if (m == 0 && triangular.size() == n) tour = triangular;
+                else if (m <= GENETIC_SEEDS) tour = nearestInsertionHeuristic(generator.below(n), *context);
+                else {
+                    arena.load(members[generator.below(std::min(m, GENETIC_SEEDS + 1))], tour);
+                    mutate(GENETIC_SEED_MUTATIONS);
+                }
+                improve();
+                arena.store(members[m], tour);
+                incumbent.offer(tour, "genetic algorithm");
+            }
+
+            for (unsigned long generation = 1; incumbent.charge(); generation++) {
+                auto tournament = [&] {
+                    unsigned int a = members[generator.below(size)], b = members[generator.below(size)];
+                    return arena.getLength(a) < arena.getLength(b) ? a : b;
+                };
+                orderCrossover(arena[tournament()], arena[tournament()], arena[child], taken, generator);
+                arena.load(child, tour);
+                tour.computeLength(length);
+                if (generator.uniform() < options.mutationRate) mutate(1);
+                improve();
+                arena.store(child, tour);
+                if (tour.getLength() < incumbent.getLength()) incumbent.offer(tour, "genetic algorithm");
+                replace(child);
+
+                if (generation % options.migrationInterval == 0 && islands > 1) {
+                    unsigned int best = *std::min_element(members.begin(), members.end(), [&](unsigned int a, unsigned int b) {
+                        return arena.getLength(a) < arena.getLength(b);
+                    });
+                    unsigned int next = (island + 1) % islands;
+                    {
+                        std::lock_guard<std::mutex> lock(mailboxes[next]);
+                        arena.copy(best, next * stride + size + 1);
+                        delivered[next] = true;
+                    }
+                    std::lock_guard<std::mutex> lock(mailboxes[island]);
+                    if (delivered[island]) {
+                        delivered[island] = false;
+                        replace(mailbox);
+                    }
+                }
+            }
+        }
+    });
+}
+
+/**
+ * Evolves tours with the island-model genetic algorithm until a deadline, with the default options
+ * (see geneticSearch)
+ * Time Complexity: O(budget + |V|²)
+ * @param budget - Time allowed for the search
+ * @return The shortest tour found on any island
+ */
+Tour Graph::geneticAlgorithm(std::chrono::milliseconds budget) const {
+    return geneticAlgorithm(budget, genetic_t());
+}
+
+/**
+ * Evolves tours with the island-model genetic algorithm until a deadline (see geneticSearch)
+ * Time Complexity: O(budget + |V|²)
+ * @param budget - Time allowed for the search
+ * @param options - Number and size of the islands, migration interval and mutation
+ * @return The shortest tour found on any island
+ */
+Tour Graph::geneticAlgorithm(std::chrono::milliseconds budget, const genetic_t &options) const {
+    Incumbent incumbent(std::chrono::steady_clock::now() + budget);
+    geneticSearch(incumbent, options);
+    return incumbent.getTour();
+}
+
+/**
+ * @brief MAX-MIN Ant System: ants build tours in parallel, guided by pheromone on the edges to each vertex's nearest
+ * neighbours, until the incumbent expires
+ * Each ant starts at a random vertex and moves to an unvisited candidate neighbour with probability proportional to
+ * pheromone^alpha * (1 / length)^beta, or to the nearest unvisited vertex once every candidate is visited; the ants
+ * of an iteration are split between the threads, each building into its own tour buffers
+ * Ants never write pheromone while building: after each iteration all of it evaporates and is clamped (in parallel,
+ * by rows), then the best tour of the iteration, or every few iterations the best one so far, deposits on its edges
+ * Pheromone is kept in [tauMin, tauMax] as in MAX-MIN Ant System, and reset to tauMax after a long stagnation
+ * Each iteration is an iteration of the incumbent
+ * Time Complexity: O(budget + |V|²)
+ * @param incumbent - Best tour shared with other solvers, which also says when to stop
+ * @param options - Colony parameters and the function receiving the statistics of every iteration
+ */
+void Graph::antColonySearch(Incumbent &incumbent, const colony_t &options) const {
+    instrumentation::Scope phase(instrumentation::Phase::ANT_COLONY);
+    unsigned int n = getNumVertex();
+    if (n < 5) { //Too few vertices for the pheromone to matter
+        incumbent.offer(nearestInsertionHeuristic(0), "ant colony");
+        incumbent.charge();
+        return;
+    }
+    auto length = [this](unsigned int a, unsigned int b) { return findEdge(a, b); };
+    std::vector<unsigned int> storage;
+    neighbours_t neighbours = neighbourLists(options.candidates, storage);
+    unsigned int k = neighbours.k;
+    unsigned int threads = parallel::threadCount(options.threads != 0 ? options.threads : threadCount);
+    unsigned int ants = std::max(options.ants, 1u);
+    uint64_t seed = options.seed != 0 ? options.seed : Xoshiro256::local()();
+
+    //Pheromone on the edge from each vertex to each of its candidates, (1 / length)^beta, and the product of the two
+    //that ants choose by (an edge is stored once at each end that has the other as a candidate)
+    size_t entries = (size_t) n * k;
+    std::vector<double> pheromone(entries), visibility(entries), choice(entries);
+    for (size_t e = 0; e < entries; e++)
+        visibility[e] = std::pow(1 / std::max(findEdge(e / k, neighbours.of(e / k)[e % k]), IMPROVEMENT_EPSILON),
+                                 options.beta);
+    auto desirability = [&](size_t e) {
+        return (options.alpha == 1 ? pheromone[e] : std::pow(pheromone[e], options.alpha)) * visibility[e];
+    };
+
+    Tour best = nearestInsertionHeuristic(Xoshiro256(seed).below(n));
+    best.computeLength(length);
+    incumbent.offer(best, "ant colony");
+    double tauMax = 1 / (options.evaporation * best.getLength());
+    double root = std::pow(COLONY_BEST_PROBABILITY, 1.0 / n);
+    auto reset = [&] {
+        std::fill(pheromone.begin(), pheromone.end(), tauMax);
+        for (size_t e = 0; e < entries; e++) choice[e] = desirability(e);
+    };
+    reset();
+
+    std::vector<Xoshiro256> generators;
+    for (unsigned int t = 0; t < threads; t++) generators.emplace_back(seed + t + 1);
+    std::vector<Tour> antTours(threads, Tour(n)), bestTours(threads, Tour(n));
+    unsigned int sinceImprovement = 0;
+
+    for (unsigned long iteration = 1; !incumbent.expired(); iteration++) {
+        auto start = std::chrono::steady_clock::now();
+        parallel::forBlocks(ants, threads, [&](unsigned int first, unsigned int last, unsigned int t) {
+            SolveContextPool::Lease context = contexts.acquire();
+            Xoshiro256 &generator = generators[t];
+            bestTours[t].clear();
+            for (unsigned int ant = first; ant < last; ant++) {
+                Tour &tour = antTours[t];
+                tour.clear();
+                std::vector<bool> &visited = context->visited;
+                visited.assign(n, false);
+                unsigned int current = generator.below(n);
+                tour.append(current, 0);
+                visited[current] = true;
+                for (unsigned int step = 1; step < n; step++) {
+                    const unsigned int *candidates = neighbours.of(current);
+                    const double *weights = choice.data() + (size_t) current * k;
+                    double total = 0;
+                    for (unsigned int c = 0; c < k; c++)
+                        if (!visited[candidates[c]]) total += weights[c];
+                    unsigned int next = constants::NO_VERTEX;
+                    if (total > 0) { //Roulette wheel over the unvisited candidates
+                        double r = generator.uniform() * total;
+                        for (unsigned int c = 0; c < k; c++) {
+                            if (visited[candidates[c]]) continue;
+                            next = candidates[c];
+                            if ((r -= weights[c]) <= 0) break;
+                        }
+                    } else {
+                        double nearest = constants::INF;
+                        for (unsigned int v = 0; v < n; v++) {
+                            if (visited[v]) continue;
+                            double l = findEdge(current, v);
+                            if (next == constants::NO_VERTEX || l < nearest) next = v, nearest = l;
+                        }
+                    }
+                    tour.append(next, findEdge(current, next));
+                    visited[next] = true;
+                    current = next;
+                }
+                tour.setLength(tour.getLength() + findEdge(current, tour[0]));
+                if (options.localSearch) {
+                    twoOptDescent(tour, neighbours, *context);
+                    tour.computeLength(length);
+                }
+                if (bestTours[t].empty() || tour.getLength() < bestTours[t].getLength()) std::swap(tour, bestTours[t]);
             }
+        });
+
+        const Tour *iterationBest = nullptr;
+        for (const Tour &tour: bestTours)
+            if (!tour.empty() && (iterationBest == nullptr || tour.getLength() < iterationBest->getLength()))
+                iterationBest = &tour;
+        if (iterationBest->getLength() < best.getLength() - IMPROVEMENT_EPSILON) {
+            best = *iterationBest;
+            incumbent.offer(best, "ant colony");
+            tauMax = 1 / (options.evaporation * best.getLength());
+            sinceImprovement = 0;
+        } else sinceImprovement++;
+        double tauMin = tauMax * (1 - root) / ((n / 2.0 - 1) * root);
+
+        if (sinceImprovement == COLONY_STAGNATION) {
+            reset();
+            sinceImprovement = 0;
+        } else {
+            parallel::forBlocks(n, threads, [&](unsigned int first, unsigned int last, unsigned int) {
+                for (size_t e = (size_t) first * k; e < (size_t) last * k; e++) {
+                    pheromone[e] = std::max(tauMin, (1 - options.evaporation) * pheromone[e]);
+                    choice[e] = desirability(e);
+                }
+            });
+            const Tour &depositor = iteration % COLONY_GLOBAL_INTERVAL == 0 ? best : *iterationBest;
+            auto deposit = [&](unsigned int a, unsigned int b) {
+                for (size_t e = (size_t) a * k; e < (size_t) (a + 1) * k; e++) {
+                    if (neighbours.of(a)[e - (size_t) a * k] != b) continue;
+                    pheromone[e] = std::min(tauMax, pheromone[e] + 1 / depositor.getLength());
+                    choice[e] = desirability(e);
+                    return;
+                }
+            };
+            for (unsigned int i = 0; i < n; i++) {
+                deposit(depositor[i], depositor[depositor.next(i)]);
+                deposit(depositor[depositor.next(i)], depositor[i]);
+            }
+        }
+
+        if (options.onIteration) {
+            std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+            options.onIteration({iteration, duration.count(), incumbent.getElapsed(), iterationBest->getLength(),
+                                 best.getLength()});
+        }
+        if (!incumbent.charge()) break;
+    }
+}
+
+/**
+ * Runs the ant colony until a deadline, with the default options (see antColonySearch)
+ * Time Complexity: O(budget + |V|²)
+ * @param budget - Time allowed for the search
+ * @return The shortest tour found by any ant
+ */
+Tour Graph::antColony(std::chrono::milliseconds budget) const {
+    return antColony(budget, colony_t());
+}
+
+/**
+ * Runs the ant colony until a deadline (see antColonySearch)
+ * Time Complexity: O(budget + |V|²)
+ * @param budget - Time allowed for the search
+ * @param options - Colony parameters and the function receiving the statistics of every iteration
+ * @return The shortest tour found by any ant
+ */
+Tour Graph::antColony(std::chrono::milliseconds budget, const colony_t &options) const {
+    Incumbent incumbent(std::chrono::steady_clock::now() + budget);
+    antColonySearch(incumbent, options);
+    return incumbent.getTour();
+}
+
+/**
+ * Splits the stops into geographic clusters, by k-means on their positions on the sphere or by a grid over their
+ * latitude and longitude, aiming for options.clusterSize stops per cluster
+ * The k-means assignment step runs in parallel, by blocks of stops
+ * Time Complexity: O(|V| * C * KMEANS_ITERATIONS), where C is the number of clusters
+ * @param options - Partition method, cluster size, threads and seed
+ * @return The dense ids of the stops in each cluster (no cluster is empty; a single one holding every stop if any
+ * stop has no coordinates)
+ */
+std::vector<std::vector<unsigned int>> Graph::clusterStops(const cluster_t &options) const {
+    unsigned int n = getNumVertex();
+    unsigned int count = std::min(n, std::max(1u, (n + options.clusterSize / 2) / std::max(options.clusterSize, 1u)));
+    std::vector<std::array<double, 3>> points(n);
+    for (unsigned int v = 0; v < n; v++) {
+        points[v] = coordinates[v].toUnitVector();
+        if (std::isnan(points[v][0])) count = 1;
+    }
+    std::vector<unsigned int> assignment(n, 0);
+
+    if (count > 1 && options.partition == cluster_t::Partition::GRID) {
+        double minLat = constants::INF, maxLat = -constants::INF, minLon = constants::INF, maxLon = -constants::INF;
+        for (const Coordinates &c: coordinates) {
+            minLat = std::min(minLat, c.getLatitude()), maxLat = std::max(maxLat, c.getLatitude());
+            minLon = std::min(minLon, c.getLongitude()), maxLon = std::max(maxLon, c.getLongitude());
+        }
+        auto side = (unsigned int) std::ceil(std::sqrt((double) count));
+        auto cell = [side](double value, double min, double max) {
+            return max > min ? std::min(side - 1, (unsigned int) ((value - min) / (max - min) * side)) : 0;
+        };
+        for (unsigned int v = 0; v < n; v++)
+            assignment[v] = cell(coordinates[v].getLatitude(), minLat, maxLat) * side
+                            + cell(coordinates[v].getLongitude(), minLon, maxLon);
+        count = side * side;
+    } else if (count > 1) {
+        auto squared = [](const std::array<double, 3> &u, const std::array<double, 3> &v) {
+            double dx = u[0] - v[0], dy = u[1] - v[1], dz = u[2] - v[2];
+            return dx * dx + dy * dy + dz * dz;
+        };
+        //k-means++: every new centre is a stop picked with probability proportional to its squared distance to the
+        //nearest centre so far
+        Xoshiro256 generator(options.seed != 0 ? options.seed : Xoshiro256::local()());
+        std::vector<std::array<double, 3>> centres{points[generator.below(n)]};
+        std::vector<double> nearest(n, constants::INF);
+        while (centres.size() < count) {
+            double total = 0;
+            for (unsigned int v = 0; v < n; v++)
+                total += nearest[v] = std::min(nearest[v], squared(points[v], centres.back()));
+            double r = generator.uniform() * total;
+            unsigned int chosen = 0;
+            while (chosen + 1 < n && (r -= nearest[chosen]) > 0) chosen++;
+            centres.push_back(points[chosen]);
+        }
+
+        //Lloyd's algorithm: assign every stop to its nearest centre, then move every centre to the mean of its stops
+        unsigned int threads = parallel::threadCount(options.threads != 0 ? options.threads : threadCount);
+        std::vector<unsigned int> changes(threads);
+        for (unsigned int iteration = 0; iteration < KMEANS_ITERATIONS; iteration++) {
+            std::fill(changes.begin(), changes.end(), 0);
+            parallel::forBlocks(n, threads, [&](unsigned int first, unsigned int last, unsigned int t) {
+                for (unsigned int v = first; v < last; v++) {
+                    unsigned int best = 0;
+                    for (unsigned int c = 1; c < count; c++)
+                        if (squared(points[v], centres[c]) < squared(points[v], centres[best])) best = c;
+                    if (iteration == 0 || best != assignment[v]) changes[t]++;
+                    assignment[v] = best;
+                }
+            });
+            if (std::accumulate(changes.begin(), changes.end(), 0u) == 0) break;
+            std::vector<std::array<double, 3>> sums(count, {0, 0, 0});
+            std::vector<unsigned int> sizes(count, 0);
+            for (unsigned int v = 0; v < n; v++) {
+                for (int d = 0; d < 3; d++) sums[assignment[v]][d] += points[v][d];
+                sizes[assignment[v]]++;
+            }
+            for (unsigned int c = 0; c < count; c++)
+                if (sizes[c] != 0)
+                    for (int d = 0; d < 3; d++) centres[c][d] = sums[c][d] / sizes[c];
+        }
+    }
+
+    std::vector<std::vector<unsigned int>> clusters(count);
+    for (unsigned int v = 0; v < n; v++) clusters[assignment[v]].push_back(v);
+    std::erase_if(clusters, [](const std::vector<unsigned int> &cluster) { return cluster.empty(); });
+    return clusters;
+}
+
+/**
+ * Fills an empty graph with some of the stops of this one and the edges between them, so it can be solved on its own
+ * Every pair of stops is joined, by its edge or else by the haversine distance, and the dense ids of the stops in
+ * this graph become their external ids in the subgraph
+ * Time Complexity: O(|S|²), where S is the set of stops
+ * @param stops - Dense ids of the stops to copy
+ * @param subgraph - Empty graph that receives them
+ */
+void Graph::buildSubgraph(std::span<const unsigned int> stops, Graph &subgraph) const {
+    for (unsigned int stop: stops) subgraph.addVertex(stop, coordinates[stop]);
+    for (unsigned int i = 0; i < stops.size(); i++)
+        for (unsigned int j = 0; j < i; j++) {
+            double length = findEdge(stops[i], stops[j]);
+            if (length >= 0) subgraph.addBidirectionalEdge(i, j, length);
+        }
+}
+
+/**
+ * Solves a single cluster: by backtracking if it has at most CLUSTER_EXACT_LIMIT stops, otherwise by the nearest
+ * insertion heuristic improved by 2-opt descent
+ * Time Complexity: O(|V|!) up to CLUSTER_EXACT_LIMIT stops, O(|V|² log(k) + moves * (k + |V|)) above
+ * @param context - Context holding the scratch state of this run
+ * @return The tour found
+ */
+Tour Graph::clusterTour(SolveContext &context) const {
+    unsigned int n = getNumVertex();
+    if (n <= 3) { //Every order is the same cycle
+        Tour tour(n);
+        for (unsigned int v = 0; v < n; v++) tour.append(v, 0);
+        tour.computeLength([this](unsigned int a, unsigned int b) { return findEdge(a, b); });
+        return tour;
+    }
+    if (n <= CLUSTER_EXACT_LIMIT) {
+        Tour tour = tspBT(context);
+        if (!tour.empty()) return tour;
+    }
+    Tour tour = nearestInsertionHeuristic(0, context);
+    std::vector<unsigned int> storage;
+    twoOptDescent(tour, neighbourLists(CLUSTER_CANDIDATES, storage), context);
+    return tour;
+}
+
+/**
+ * Solves the graph by geographic decomposition, with the default options (see clusteredTSPTour(options))
+ * Time Complexity: O(|V| * (C * KMEANS_ITERATIONS + S)), where C is the number of clusters and S their size
+ * @return The tour found
+ */
+Tour Graph::clusteredTSPTour() const {
+    return clusteredTSPTour(cluster_t());
+}
+
+/**
+ * @brief Solves the graph by geographic decomposition, for real-world graphs too large to solve as a whole
+ * 1. The stops are split into clusters by their coordinates (see clusterStops)
+ * 2. Each cluster is copied into a graph of its own and solved independently, the clusters being split between the
+ * threads (see clusterTour)
+ * 3. The order of the clusters is solved as a small TSP between their centres, and the cluster tours are stitched in
+ * that order: each one is cut open at one of its edges and entered at one end of the cut, and every pass moves the
+ * cut of each cluster to the edge and direction that are shortest given the exits and entries of its neighbours
+ * Time Complexity: O(|V| * (C * KMEANS_ITERATIONS + S)), where C is the number of clusters and S their size
+ * (the cost of each cluster's heuristic aside)
+ * @param options - Partition method, cluster size, threads and seed
+ * @return The tour found
+ */
+Tour Graph::clusteredTSPTour(const cluster_t &options) const {
+    instrumentation::Scope phase(instrumentation::Phase::CLUSTERING);
+    auto length = [this](unsigned int a, unsigned int b) { return findEdge(a, b); };
+    std::vector<std::vector<unsigned int>> clusters = clusterStops(options);
+    auto count = (unsigned int) clusters.size();
+    if (count <= 1) {
+        SolveContextPool::Lease context = contexts.acquire();
+        return clusterTour(*context);
+    }
+
+    //Solve every cluster, replacing its stops by their order in the cluster's tour
+    unsigned int threads = parallel::threadCount(options.threads != 0 ? options.threads : threadCount);
+    parallel::forBlocks(count, threads, [&](unsigned int first, unsigned int last, unsigned int) {
+        for (unsigned int c = first; c < last; c++) {
+            Graph subgraph;
+            buildSubgraph(clusters[c], subgraph);
+            SolveContextPool::Lease context = subgraph.contexts.acquire();
+            Tour tour = subgraph.clusterTour(*context);
+            for (unsigned int i = 0; i < tour.size(); i++) clusters[c][i] = subgraph.getExternalId(tour[i]);
+        }
+    });
+
+    //Order the clusters by a tour between their centres
+    Graph centres;
+    std::vector<std::array<double, 3>> points(count, {0, 0, 0});
+    for (unsigned int c = 0; c < count; c++) {
+        for (unsigned int stop: clusters[c]) {
+            std::array<double, 3> point = coordinates[stop].toUnitVector();
+            for (int d = 0; d < 3; d++) points[c][d] += point[d];
+        }
+        double norm = std::hypot(points[c][0], points[c][1], points[c][2]);
+        for (int d = 0; d < 3; d++) points[c][d] /= norm;
+        centres.addVertex(c);
+    }
+    for (unsigned int i = 0; i < count; i++)
+        for (unsigned int j = 0; j < i; j++)
+            centres.addBidirectionalEdge(i, j, Coordinates::distanceBetween(points[i], points[j]));
+    std::vector<unsigned int> order;
+    {
+        SolveContextPool::Lease context = centres.contexts.acquire();
+        Tour tour = centres.clusterTour(*context);
+        order.assign(tour.begin(), tour.end());
+    }
+
+    //Each cluster is cut open after position cut[c] and walked forwards (from the stop after the cut round to the
+    //one before) or backwards
+    std::vector<unsigned int> cut(count, 0);
+    std::vector<bool> forwards(count, true);
+    auto entry = [&](unsigned int c) {
+        const std::vector<unsigned int> &stops = clusters[c];
+        unsigned int after = (cut[c] + 1) % stops.size();
+        return forwards[c] ? stops[after] : stops[cut[c]];
+    };
+    auto exit = [&](unsigned int c) {
+        const std::vector<unsigned int> &stops = clusters[c];
+        unsigned int after = (cut[c] + 1) % stops.size();
+        return forwards[c] ? stops[cut[c]] : stops[after];
+    };
+    for (unsigned int pass = 0; pass < CLUSTER_STITCH_PASSES; pass++) {
+        for (unsigned int i = 0; i < count; i++) {
+            unsigned int c = order[i], previous = order[(i + count - 1) % count], next = order[(i + 1) % count];
+            const std::vector<unsigned int> &stops = clusters[c];
+            if (stops.size() == 1) continue;
+            //The first pass places the cuts one after the other, so only the previous cluster is known
+            bool joinNext = pass > 0 || i == count - 1;
+            double best = constants::INF;
+            for (unsigned int j = 0; j < stops.size(); j++) {
+                unsigned int a = stops[j], b = stops[(j + 1) % stops.size()];
+                for (bool direction: {true, false}) {
+                    unsigned int in = direction ? b : a, out = direction ? a : b;
+                    double cost = (i > 0 || pass > 0 ? length(exit(previous), in) : 0)
+                                  + (joinNext ? length(out, entry(next)) : 0) - length(a, b);
+                    if (cost < best) best = cost, cut[c] = j, forwards[c] = direction;
+                }
+            }
+        }
+    }
+
+    Tour tour(getNumVertex());
+    for (unsigned int c: order) {
+        const std::vector<unsigned int> &stops = clusters[c];
+        auto size = (unsigned int) stops.size();
+        for (unsigned int step = 0; step < size; step++) {
+            unsigned int stop = forwards[c] ? stops[(cut[c] + 1 + step) % size] : stops[(cut[c] + size - step) % size];
+            tour.append(stop, 0);
         }
     }
+    tour.computeLength(length);
+    return tour;
 }
 
 /**
  * Nearest insertion heuristic for the Travelling Salesperson Problem
- * Time Complexity: 0(|V|³)
+ * Time Complexity: 0(|V|²)
  * @param start - Id of the start Vertex for the route
- * @return - Route length
+ * @return - The tour found
  */
-std::pair<double, std::vector<unsigned int>> Graph::nearestInsertionHeuristic(unsigned int &start) {
-    double distance = 0;
-    std::vector<unsigned int> tour;
-    UFDS tourSets(vertexSet.size());
+Tour Graph::nearestInsertionHeuristic(const unsigned int &start) const {
+    SolveContextPool::Lease context = contexts.acquire();
+    return nearestInsertionHeuristic(start, *context);
+}
+
+/**
+ * Nearest insertion heuristic for the Travelling Salesperson Problem
+ * Time Complexity: 0(|V|²)
+ * @param start - Id of the start Vertex for the route
+ * @param context - Context holding the scratch state of this run
+ * @return - The tour found
+ */
+Tour Graph::nearestInsertionHeuristic(const unsigned int &start, SolveContext &context) const {
+    instrumentation::Scope phase(instrumentation::Phase::INSERTION);
+    Tour tour(getNumVertex());
+    context.prepare(getNumVertex());
+    std::vector<bool> &inTour = context.visited;
+    std::vector<double> &tourDistance = context.dist;
 
     //Get shortest adjacent edge
-    std::vector<double> adjacent = distanceMatrix[start];
-    auto it = std::min_element(adjacent.begin(), adjacent.end());
-    unsigned int minEdgeIndex = std::distance(adjacent.begin(), it);
+    unsigned int minEdgeIndex = start;
+    double minEdgeLength = constants::INF;
+    distanceMatrix.forEachInRow(start, [&](unsigned int i, double length) {
+        if (length < minEdgeLength) {
+            minEdgeLength = length;
+            minEdgeIndex = i;
+        }
+    });
 
     //Initialize the partial tour with the chosen vertex and its closest neighbour
-    tour.push_back(start);
-    tour.push_back(minEdgeIndex);
-    tourSets.linkSets(start, minEdgeIndex);
-    distance += distanceMatrix[start][minEdgeIndex];
+    tour.append(start, 0);
+    tour.append(minEdgeIndex, minEdgeLength);
+    updateTourDistances(start, inTour, tourDistance);
+    updateTourDistances(minEdgeIndex, inTour, tourDistance);
 
     //Two cities are already in the tour, repeat for the leftover cities
-    for (int i = 2; i < vertexSet.size(); i++) {
-        std::pair<unsigned int, unsigned int> nextEdge = getNextHeuristicEdge(tour, tourSets);
-        unsigned int newVertexId = nextEdge.second;
+    for (unsigned int i = 2; i < getNumVertex(); i++) {
+        unsigned int newVertexId = getNextHeuristicVertex(inTour, tourDistance);
 
         auto insertionEdges = getInsertionEdges(tour, newVertexId);
-
-        unsigned int closingVertex = insertionEdges.first.back();
-        auto closingVertexIt = std::find(tour.begin(), tour.end(), closingVertex);
-        tour.insert(closingVertexIt, newVertexId); //Insert new vertex in between the two old vertices
-
-        tourSets.linkSets(start, newVertexId);
-
-        //Remove the length of the edge that was replaced, and add the length of the two new edges
-        distance =
-                distance - distanceMatrix[insertionEdges.first[0]][insertionEdges.first.back()] + insertionEdges.second;
+        if (insertionEdges.first.empty()) { //No way to connect the vertex to the tour
+            tour.append(newVertexId, constants::INF);
+        } else {
+            unsigned int closingVertex = insertionEdges.first.back();
+            //Insert new vertex in between the two old vertices, removing the length of the edge that was replaced
+            //and adding the length of the two new edges
+            tour.insert(tour.positionOf(closingVertex), newVertexId,
+                        insertionEdges.second - distanceMatrix.get(insertionEdges.first[0], closingVertex));
+        }
+        updateTourDistances(newVertexId, inTour, tourDistance);
     }
     //The two untied edges will always be the starting two vertices
-    tour.push_back(start);
-    return {distance + distanceMatrix[minEdgeIndex][start], tour};
+    tour.setLength(tour.getLength() + distanceMatrix.get(minEdgeIndex, start));
+    return tour;
 }
 
 /**
- * Calculates the nearest edge to any of the vertices in a given tour
- * Time Complexity: O(|V|²)
- * @param tour - Vector of the vertex ids in the tour
- * @param tourSets - UFDS that separates into sets the vertices in tour from the ones not in tour
- * @return A pair of unsigned ints representing the ids of the chosen edges' extremities
+ * Marks a vertex as part of the tour and lowers the distance to the tour of the vertices outside it
+ * Reads a single row of the distance matrix, in storage order
+ * Time Complexity: O(|V|)
+ * @param id - Id of the vertex added to the tour
+ * @param inTour - Whether each vertex is already in the tour
+ * @param tourDistance - Length of the shortest edge from each vertex to the tour
+ */
+void Graph::updateTourDistances(unsigned int id, std::vector<bool> &inTour, std::vector<double> &tourDistance) const {
+    inTour[id] = true;
+    distanceMatrix.forEachInRow(id, [&](unsigned int i, double length) {
+        if (length < tourDistance[i]) tourDistance[i] = length;
+    });
+}
+
+/**
+ * Calculates the vertex outside the tour that is nearest to any of the vertices in it
+ * Time Complexity: O(|V|)
+ * @param inTour - Whether each vertex is already in the tour
+ * @param tourDistance - Length of the shortest edge from each vertex to the tour
+ * @return Id of the chosen vertex
  */
-std::pair<unsigned int, unsigned int> Graph::getNextHeuristicEdge(std::vector<unsigned int> tour, UFDS tourSets) {
+unsigned int Graph::getNextHeuristicVertex(const std::vector<bool> &inTour, const std::vector<double> &tourDistance) {
+    unsigned int next = 0;
     double smallestLength = constants::INF;
-    std::pair<unsigned int, unsigned int> edgeExtremities;
-
-    for (auto id: tour) {
-        for (int i = 0; i < distanceMatrix[id].size(); i++) {
-            //If it's an edge to a vertex not yet in the tour
-            if (!tourSets.isSameSet(tour[0], i)) {
-                if (distanceMatrix[id][i] < smallestLength) {
-                    smallestLength = distanceMatrix[id][i];
-                    edgeExtremities = {id, i};
-                }
-            }
+    bool found = false;
+
+    for (unsigned int i = 0; i < tourDistance.size(); i++) {
+        if (inTour[i]) continue;
+        if (!found || tourDistance[i] < smallestLength) {
+            smallestLength = tourDistance[i];
+            next = i;
+            found = true;
         }
     }
-    return edgeExtremities;
+    return next;
 }
 
 /**
  * Returns the two edges that should be added to the tour for the insertion of the vertex given by newVertexId
  * Time Complexity: O(|V|)
- * @param tour - Vector of the vertex ids in the tour
+ * @param tour - Partial tour (its closing edge is never replaced)
  * @param newVertexId - Id of the Vertex to be added to the tour
  * @return A pair of a 3-element vector, representing the order in which the two new edges will unite the new vertex to two pre-existing ones, and a double representing the length of the the two new edges
  */
 std::pair<std::vector<unsigned int>, double>
-Graph::getInsertionEdges(std::vector<unsigned int> tour, const unsigned int newVertexId) const {
+Graph::getInsertionEdges(const Tour &tour, const unsigned int newVertexId) const {
     std::pair<std::vector<unsigned int>, double> result = {{}, constants::INF};
+    if (tour.size() > 1) instrumentation::count(instrumentation::Counter::INSERTION_EVALUATIONS, tour.size() - 1);
 
-    for (int i = 0; i < tour.size() - 1; i++) {
+    for (unsigned int i = 0; i + 1 < tour.size(); i++) {
         //If there are two edges that could replace the current one, connecting its ends to the new vertex
-        double currentDistance = distanceMatrix[tour[i]][newVertexId] + distanceMatrix[newVertexId][tour[i + 1]];
+        double currentDistance = distanceMatrix.get(tour[i], newVertexId) + distanceMatrix.get(newVertexId, tour[i + 1]);
         if (currentDistance < result.second) {
             result.second = currentDistance;
             result.first = {tour[i], newVertexId, tour[i + 1]};
@@ -419,13 +1648,640 @@ Graph::getInsertionEdges(std::vector<unsigned int> tour, const unsigned int newV
  * Clears all of the graph's current information
  */
 void Graph::clearGraph() {
-    distanceMatrix = {};
-    vertexSet = {};
+    distanceMatrix.clear();
+    coordinates = {};
+    candidates = {};
+    candidatesPerVertex = 0;
+    adjacencyOffsets = {};
+    adjacencyTargets = {};
+    adjacencyLengths = {};
+    adjacencyValid.store(false, std::memory_order_relaxed);
+    closureVia = {};
+    contexts.clear();
+    ids.clear();
+    totalEdges = 0;
+}
+
+/**
+ * Changes how edge lengths are stored, keeping the current ones (rounded to the new precision)
+ * Time Complexity: O(|V|²)
+ * @param layout - FULL square matrix, PACKED lower triangle or TILED lower triangle
+ * @param precision - DOUBLE, FLOAT or FIXED point elements
+ * @param scale - Multiplier applied to lengths before rounding them to integers, used by FIXED only
+ * @param backingDirectory - Directory where a memory-mapped file holds the lengths, or empty to keep them in RAM
+ */
+void Graph::setDistanceStorage(DistanceMatrix::Layout layout, DistanceMatrix::Precision precision, double scale,
+                               const std::string &backingDirectory) {
+    distanceMatrix.convert(layout, precision, scale, backingDirectory);
+}
+
+/**
+ * Upper bound on the difference between a tour length computed from the stored lengths and the exact one
+ * Time Complexity: O(1)
+ * @param length - Computed tour length
+ * @param edges - Number of edges in the tour
+ */
+double Graph::getDistanceMaxError(double length, unsigned int edges) const {
+    return distanceMatrix.getMaxError(length, edges);
+}
+
+/**
+ * @return Number of bytes used to store edge lengths
+ */
+size_t Graph::getDistanceMemoryUsage() const {
+    return distanceMatrix.getMemoryUsage();
+}
+
+
+
+/**
+ * Builds a minimum 1-tree over the edge lengths plus the given node penalties: a MST of every vertex but 0, rooted
+ * at vertex 1, plus the two cheapest edges of vertex 0
+ * Missing edges take the haversine distance, as in findEdge, so the tree lower-bounds the tours the solvers build
+ * The MST is built by prim, or by boruvka in parallel when the graph may use more than one thread
+ * Time Complexity: O(|V|²) (O(|V|² log(|V|) / threads) in parallel)
+ * @param penalties - Penalty of each vertex, added to the length of every edge touching it
+ * @param context - Context that receives the tree, in parent and dist, and the degree of every vertex in it
+ * @return Total penalised length of the 1-tree, or constants::INF if no 1-tree spans the graph
+ */
+double Graph::oneTree(const std::vector<double> &penalties, SolveContext &context) const {
+    unsigned int n = getNumVertex();
+    std::vector<std::array<double, 3>> &points = context.points;
+    points.resize(n);
+    for (unsigned int v = 0; v < n; v++) points[v] = coordinates[v].toUnitVector();
+    auto penalised = [&](unsigned int v, unsigned int i, double length) {
+        if (length == constants::INF) {
+            length = Coordinates::distanceBetween(points[v], points[i]);
+            if (length < 0) return constants::INF; //Neither an edge nor coordinates to measure it
+        }
+        return length + penalties[v] + penalties[i];
+    };
+    auto withoutFirst = [&](unsigned int v, unsigned int i, double length) {
+        return v == 0 || i == 0 ? constants::INF : penalised(v, i, length);
+    };
+    double weight = threadCount > 1 ? boruvkaTree(context, threadCount, 1, false, withoutFirst)
+                                    : primTree(context, 1, withoutFirst);
+
+    std::vector<int> &degree = context.degree;
+    degree.assign(n, 0);
+    for (unsigned int v = 1; v < n; v++) {
+        if (!context.visited[v]) return constants::INF;
+        if (context.parent[v] == constants::NO_VERTEX) continue;
+        degree[v]++;
+        degree[context.parent[v]]++;
+    }
+
+    //Vertex 0 joins the tree by its two cheapest edges
+    unsigned int first = constants::NO_VERTEX, second = constants::NO_VERTEX;
+    double firstLength = constants::INF, secondLength = constants::INF;
+    distanceMatrix.forEachInRow(0, [&](unsigned int i, double length) {
+        length = penalised(0, i, length);
+        if (length < firstLength) {
+            second = first, secondLength = firstLength;
+            first = i, firstLength = length;
+        } else if (length < secondLength) second = i, secondLength = length;
+    });
+    if (second == constants::NO_VERTEX) return constants::INF;
+    degree[0] = 2;
+    degree[first]++;
+    degree[second]++;
+    context.parent[0] = first;
+    context.dist[0] = firstLength;
+    return weight + firstLength + secondLength;
+}
+
+/**
+ * @brief Computes the Held-Karp lower bound on the length of any tour, by subgradient optimisation of node penalties
+ * Every tour is a 1-tree, so the minimum 1-tree minus twice the penalties is a lower bound for any penalties; each
+ * iteration moves the penalties towards making every degree 2, with a step proportional to the distance between the
+ * current bound and a known tour length, halved whenever the bound stops improving
+ * Time Complexity: O(iterations * |V|²)
+ * @param iterations - Maximum number of 1-trees to compute (at least one is)
+ * @param upperBound - Length of a known tour (constants::INF to use the triangular approximation's, or the sum of
+ *                     the longest edge at every vertex if it finds none)
+ * @return The best bound found, with the penalties that gave it and the number of iterations run
+ */
+Graph::lower_bound_t Graph::heldKarpBound(unsigned int iterations, double upperBound) const {
+    unsigned int n = getNumVertex();
+    lower_bound_t result = {0, std::vector<double>(n, 0), 0};
+    if (n < 2) return result;
+    if (n == 2) {
+        result.bound = 2 * findEdge(0, 1);
+        return result;
+    }
+    if (upperBound == constants::INF) upperBound = triangularTSPTour().getLength();
+    if (upperBound == constants::INF) {
+        //No known tour: every tour uses two edges at each vertex, so it is no longer than the sum of the longest
+        //edge at every vertex, a finite length that still scales the steps
+        std::vector<double> longest(n, 0);
+        distanceMatrix.forEachEntry([&](unsigned int i, unsigned int j, double length) {
+            if (length == constants::INF) return;
+            longest[i] = std::max(longest[i], length);
+            longest[j] = std::max(longest[j], length);
+        });
+        upperBound = std::accumulate(longest.begin(), longest.end(), 0.0);
+    }
+
+    SolveContextPool::Lease context = contexts.acquire();
+    iterations = std::max(iterations, 1u);
+    std::vector<double> penalties(n, 0);
+    double step = 1;
+    unsigned int sinceImprovement = 0;
+    result.bound = -constants::INF;
+    for (; result.iterations < iterations; result.iterations++) {
+        double weight = oneTree(penalties, *context);
+        if (weight == constants::INF) { //No tour can visit every vertex
+            result.bound = constants::INF;
+            result.iterations++;
+            break;
+        }
+        for (double penalty: penalties) weight -= 2 * penalty;
+        if (weight > result.bound) {
+            result.bound = weight;
+            result.penalties = penalties;
+            sinceImprovement = 0;
+        } else if (++sinceImprovement == HELD_KARP_PATIENCE) {
+            step /= 2;
+            sinceImprovement = 0;
+        }
+
+        //With every degree 2 the 1-tree is a tour, so the bound is already the optimal length
+        double norm = 0;
+        for (int degree: context->degree) norm += (degree - 2) * (degree - 2);
+        if (norm == 0 || weight >= upperBound || step < HELD_KARP_MIN_STEP) {
+            result.iterations++;
+            break;
+        }
+        double t = step * (upperBound - weight) / norm;
+        if (!std::isfinite(t)) { //Penalties must stay finite, or every later 1-tree is meaningless
+            result.iterations++;
+            break;
+        }
+        for (unsigned int v = 0; v < n; v++) penalties[v] += t * (context->degree[v] - 2);
+    }
+    return result;
+}
+
+/**
+ * Builds, for every vertex, the list of its k nearest neighbours sorted by edge length
+ * With the penalties of heldKarpBound, neighbours are ranked by penalised length instead, which favours the edges
+ * likely to be in an optimal tour over those that are merely short
+ * Time Complexity: O(|V|² log(k))
+ * @param k - Number of neighbours kept per vertex
+ * @param penalties - Penalty of each vertex, added to the length of every edge touching it (empty for none)
+ */
+void Graph::buildCandidateLists(unsigned int k, const std::vector<double> &penalties) {
+    candidatesPerVertex = nearestNeighbours(k, penalties, candidates);
+}
+
+/**
+ * Finds the k nearest neighbours of every vertex, sorted by edge length (see buildCandidateLists)
+ * The distance matrix is read once, in storage order, so it streams even when it is memory-mapped
+ * Time Complexity: O(|V|² log(k))
+ * @param k - Number of neighbours kept per vertex (at most |V| - 1 are)
+ * @param penalties - Penalty of each vertex, added to the length of every edge touching it (empty for none)
+ * @param neighbours - Receives the neighbours of each vertex, k per vertex, stored contiguously
+ * @return Number of neighbours kept per vertex
+ */
+unsigned int Graph::nearestNeighbours(unsigned int k, const std::vector<double> &penalties,
+                                      std::vector<unsigned int> &neighbours) const {
+    unsigned int n = getNumVertex();
+    k = std::min(k, n == 0 ? 0 : n - 1);
+    if (k == 0) {
+        neighbours = {};
+        return 0;
+    }
+
+    //Max-heap of (length, id) per vertex, holding the k shortest edges seen so far
+    std::vector<std::pair<double, unsigned int>> nearest((size_t) n * k);
+    std::vector<unsigned int> count(n, 0);
+    auto offer = [&](unsigned int v, unsigned int neighbour, double length) {
+        auto first = nearest.begin() + (long) ((size_t) v * k);
+        if (count[v] < k) {
+            first[count[v]++] = {length, neighbour};
+            std::push_heap(first, first + count[v]);
+        } else if (length < first->first) {
+            std::pop_heap(first, first + k);
+            first[k - 1] = {length, neighbour};
+            std::push_heap(first, first + k);
+        }
+    };
+    distanceMatrix.forEachEntry([&](unsigned int i, unsigned int j, double length) {
+        if (length == constants::INF) return;
+        if (!penalties.empty()) length += penalties[i] + penalties[j];
+        offer(i, j, length);
+        offer(j, i, length);
+    });
+
+    neighbours.assign((size_t) n * k, 0);
+    for (unsigned int v = 0; v < n; v++) {
+        auto first = nearest.begin() + (long) ((size_t) v * k);
+        std::sort_heap(first, first + count[v]);
+        for (unsigned int c = 0; c < k; c++)
+            //Vertices with fewer than k edges repeat their farthest neighbour (or themselves if isolated)
+            neighbours[(size_t) v * k + c] = count[v] == 0 ? v : first[std::min(c, count[v] - 1)].second;
+    }
+    return k;
+}
+
+/**
+ * @param id - Id of the vertex
+ * @return The candidate neighbours of the vertex, nearest first (empty if buildCandidateLists wasn't called)
+ */
+std::span<const unsigned int> Graph::getCandidates(unsigned int id) const {
+    if (candidatesPerVertex == 0) return {};
+    return {candidates.data() + (size_t) id * candidatesPerVertex, candidatesPerVertex};
+}
+
+/**
+ * Nearest neighbours for a search that joins each vertex to up to k of them: the first k of the candidate lists built
+ * at load, or lists found for the search if the graph has none, they are shorter or they miss vertices added since
+ * Time Complexity: O(1) with candidate lists, O(|V|² log(k)) without
+ * @param k - Neighbours wanted per vertex (at most |V| - 1 are used)
+ * @param storage - Receives the lists found for the search, if any; it must outlive the result
+ * @return The lists to use
+ */
+Graph::neighbours_t Graph::neighbourLists(unsigned int k, std::vector<unsigned int> &storage) const {
+    unsigned int n = getNumVertex();
+    k = std::min(k, n == 0 ? 0 : n - 1);
+    if (candidatesPerVertex >= k && (size_t) n * candidatesPerVertex <= candidates.size())
+        return {candidates.data(), k, candidatesPerVertex};
+    k = nearestNeighbours(k, {}, storage);
+    return {storage.data(), k, k};
+}
+
+/**
+ * Sets how many threads the parallel algorithms may use
+ * @param threads - Number of threads (0 for one per hardware thread)
+ */
+void Graph::setThreadCount(unsigned int threads) {
+    threadCount = parallel::threadCount(threads);
+}
+
+unsigned int Graph::getThreadCount() const {
+    return threadCount;
+}
+
+/**
+ * Position of the pair of stops (i, j) in the lower triangle of closureVia
+ */
+static size_t closureIndex(unsigned int i, unsigned int j) {
+    size_t hi = std::max(i, j), lo = std::min(i, j);
+    return hi * (hi + 1) / 2 + lo;
+}
+
+/**
+ * @return Whether every pair of stops is joined by an edge
+ */
+bool Graph::isComplete() const {
+    unsigned int n = getNumVertex();
+    bool complete = true;
+    distanceMatrix.forEachEntry([&complete](unsigned int, unsigned int, double length) {
+        if (length == constants::INF) complete = false;
+    });
+    return complete || n < 2;
+}
+
+/**
+ * @brief Replaces the length of every pair of stops by the length of the shortest path between them, so missing edges
+ * no longer fall back to the haversine distance and the triangle inequality holds
+ * Graphs of up to FLOYD_WARSHALL_LIMIT stops are closed by blocked Floyd–Warshall, larger ones by Dijkstra from
+ * every stop over the adjacency lists, both in parallel; a stop on each path is kept so expandPath can recover the
+ * real route of any edge of a tour
+ * Pairs with no path between them keep no edge, and the closure must be built again after edges change
+ * Candidate lists built before are built again over the new lengths
+ * Time Complexity: O(|V|³ / threads) up to FLOYD_WARSHALL_LIMIT stops, O(|V| * |E| log(|V|) / threads) above
+ */
+void Graph::buildMetricClosure() {
+    instrumentation::Scope phase(instrumentation::Phase::METRIC_CLOSURE);
+    unsigned int n = getNumVertex();
+    closureVia.assign((size_t) n * (n + 1) / 2, constants::NO_VERTEX);
+    if (n > FLOYD_WARSHALL_LIMIT) {
+        closureDijkstra(threadCount);
+    } else {
+        std::vector<double> dist((size_t) n * n, 0);
+        std::vector<unsigned int> via((size_t) n * n, constants::NO_VERTEX);
+        for (unsigned int i = 0; i < n; i++)
+            distanceMatrix.forEachInRow(i, [&](unsigned int j, double length) { dist[(size_t) i * n + j] = length; });
+        floydWarshall(dist, via, n, threadCount);
+        for (unsigned int i = 0; i < n; i++)
+            for (unsigned int j = 0; j < i; j++) {
+                double length = dist[(size_t) i * n + j];
+                if (length != distanceMatrix.get(i, j)) distanceMatrix.set(i, j, length);
+                closureVia[closureIndex(i, j)] = via[(size_t) i * n + j];
+            }
+    }
+    //Every connected pair now has an edge, so prim and boruvka must see the graph as dense
     totalEdges = 0;
+    distanceMatrix.forEachEntry([this](unsigned int, unsigned int, double length) {
+        if (length != constants::INF) totalEdges++;
+    });
+    adjacencyValid.store(false, std::memory_order_relaxed);
+    if (candidatesPerVertex != 0) buildCandidateLists(candidatesPerVertex);
+}
+
+/**
+ * @brief Blocked Floyd–Warshall on a square matrix: for every block of intermediate stops, the diagonal block is
+ * relaxed first, then the blocks in its row and column, then all the others, the blocks of each phase in parallel
+ * Each block is relaxed through FLOYD_WARSHALL_BLOCK intermediate stops while it stays in cache, instead of the
+ * whole matrix being streamed once per stop
+ * Time Complexity: O(n³ / threads)
+ * @param dist - Row-major n x n lengths (constants::INF for no edge), replaced by the shortest path lengths
+ * @param via - Row-major n x n, receives the last intermediate stop that shortened each path
+ * @param n - Number of stops
+ * @param threads - Number of threads to use (0 for one per hardware thread)
+ */
+void Graph::floydWarshall(std::vector<double> &dist, std::vector<unsigned int> &via, unsigned int n,
+                          unsigned int threads) {
+    const unsigned int B = FLOYD_WARSHALL_BLOCK;
+    unsigned int blocks = (n + B - 1) / B;
+    auto relax = [&](unsigned int ib, unsigned int jb, unsigned int kb) {
+        unsigned int jFirst = jb * B, jLast = std::min(n, jFirst + B);
+        for (unsigned int k = kb * B; k < std::min(n, kb * B + B); k++) {
+            const double *rowK = dist.data() + (size_t) k * n;
+            for (unsigned int i = ib * B; i < std::min(n, ib * B + B); i++) {
+                double *rowI = dist.data() + (size_t) i * n;
+                double ik = rowI[k];
+                if (ik == constants::INF) continue;
+                for (unsigned int j = jFirst; j < jLast; j++)
+                    if (ik + rowK[j] < rowI[j]) {
+                        rowI[j] = ik + rowK[j];
+                        via[(size_t) i * n + j] = k;
+                    }
+            }
+        }
+    };
+    for (unsigned int kb = 0; kb < blocks; kb++) {
+        relax(kb, kb, kb);
+        parallel::forBlocks(blocks, threads, [&](unsigned int first, unsigned int last, unsigned int) {
+            for (unsigned int b = first; b < last; b++) {
+                if (b == kb) continue;
+                relax(kb, b, kb);
+                relax(b, kb, kb);
+            }
+        });
+        parallel::forBlocks(blocks, threads, [&](unsigned int first, unsigned int last, unsigned int) {
+            for (unsigned int ib = first; ib < last; ib++)
+                for (unsigned int jb = 0; jb < blocks; jb++)
+                    if (ib != kb && jb != kb) relax(ib, jb, kb);
+        });
+    }
+}
+
+/**
+ * Builds the metric closure by Dijkstra from every stop over the adjacency lists, the stops split between the
+ * threads; each run writes only the pairs whose other stop has a smaller id, so no entry is written twice
+ * Time Complexity: O(|V| * |E| log(|V|) / threads)
+ * @param threads - Number of threads to use (0 for one per hardware thread)
+ */
+void Graph::closureDijkstra(unsigned int threads) {
+    buildAdjacency();
+    unsigned int n = getNumVertex();
+    parallel::forBlocks(n, threads, [&](unsigned int first, unsigned int last, unsigned int) {
+        IndexedHeap<4> heap(n);
+        std::vector<double> dist(n);
+        std::vector<unsigned int> previous(n);
+        for (unsigned int source = first; source < last; source++) {
+            std::fill(dist.begin(), dist.end(), constants::INF);
+            dist[source] = 0;
+            previous[source] = source;
+            heap.insert(source, 0);
+            while (!heap.empty()) {
+                unsigned int current = heap.extractMin();
+                for (unsigned int e = adjacencyOffsets[current]; e < adjacencyOffsets[current + 1]; e++) {
+                    unsigned int i = adjacencyTargets[e];
+                    if (dist[current] + adjacencyLengths[e] >= dist[i]) continue;
+                    dist[i] = dist[current] + adjacencyLengths[e];
+                    previous[i] = current;
+                    heap.insertOrDecrease(i, dist[i]);
+                }
+            }
+            for (unsigned int target = 0; target < source; target++) {
+                if (dist[target] == constants::INF) continue;
+                if (dist[target] != distanceMatrix.get(source, target))
+                    distanceMatrix.set(source, target, dist[target]);
+                if (previous[target] != source) closureVia[closureIndex(source, target)] = previous[target];
+            }
+        }
+    });
+}
+
+/**
+ * @return Whether buildMetricClosure was called since the graph was loaded
+ */
+bool Graph::hasMetricClosure() const {
+    return !closureVia.empty();
+}
+
+/**
+ * Recovers the stops along the edge between two stops: the real route behind a length filled in by the metric
+ * closure, or just the two stops for an edge of the graph (or if there is no closure)
+ * Time Complexity: O(|P|), where P is the path
+ * @param source - Dense id of the first stop
+ * @param dest - Dense id of the last stop
+ * @return The stops of the path, from source to dest
+ */
+std::vector<unsigned int> Graph::expandPath(unsigned int source, unsigned int dest) const {
+    std::vector<unsigned int> path{source};
+    if (source == dest) return path;
+    //Pending ends of the path, last first: each pair (a, b) is split at its stop until it is a direct edge
+    std::vector<unsigned int> pending{dest};
+    unsigned int current = source;
+    while (!pending.empty()) {
+        unsigned int next = pending.back();
+        unsigned int via = closureVia.empty() ? constants::NO_VERTEX : closureVia[closureIndex(current, next)];
+        //Paths never repeat a stop, so a longer one can only come from edges of length 0 and is cut short
+        bool split = via != constants::NO_VERTEX && via != current && via != next;
+        if (split && path.size() + pending.size() <= getNumVertex()) {
+            pending.push_back(via);
+            continue;
+        }
+        pending.pop_back();
+        path.push_back(next);
+        current = next;
+    }
+    return path;
+}
+
+/**
+ * Expands every edge of a tour into its real route (see expandPath)
+ * Time Complexity: O(|P|), where P is the expanded route
+ * @param tour - Tour to expand
+ * @return The stops of the route, starting and ending at the first stop of the tour
+ */
+std::vector<unsigned int> Graph::expandTour(const Tour &tour) const {
+    std::vector<unsigned int> route;
+    if (tour.empty()) return route;
+    route.push_back(tour[0]);
+    for (unsigned int i = 0; i < tour.size(); i++) {
+        std::vector<unsigned int> path = expandPath(tour[i], tour[tour.next(i)]);
+        route.insert(route.end(), path.begin() + 1, path.end());
+    }
+    return route;
+}
+
+/**
+ * @brief Improves a tour locally after a change, with 2-opt and or-opt moves around the stops it touched
+ * Each examined stop tries to join one of its nearest neighbours in the tour (from the candidate lists if it has one,
+ * otherwise by scanning its row), by a 2-opt move or by moving the segment of up to three stops starting at it
+ * beside the neighbour; the stops at the ends of every applied move are examined in turn
+ * At most REPAIR_STEPS stops are examined, so a repair costs the same whatever the size of the tour
+ * Time Complexity: O(REPAIR_STEPS * (k + |V|)) (O(REPAIR_STEPS * k) plus the moves with candidate lists)
+ * @param tour - Tour to repair
+ * @param active - Stops whose surroundings changed
+ */
+void Graph::repairTour(Tour &tour, std::vector<unsigned int> active) const {
+    unsigned int n = tour.size();
+    if (n < 5) return;
+    auto length = [this](unsigned int a, unsigned int b) { return findEdge(a, b); };
+    auto activate = [&](unsigned int v) {
+        if (std::find(active.begin(), active.end(), v) == active.end()) active.push_back(v);
+    };
+    std::vector<unsigned int> neighbours;
+    std::vector<std::pair<double, unsigned int>> nearest;
+
+    for (unsigned int step = 0; step < REPAIR_STEPS && !active.empty(); step++) {
+        unsigned int a = active.back();
+        active.pop_back();
+        if (!tour.contains(a)) continue;
+        //Nearest neighbours that are in the tour
+        neighbours.clear();
+        //Stops added after buildCandidateLists have no list
+        if (candidatesPerVertex != 0 && (size_t) (a + 1) * candidatesPerVertex <= candidates.size()) {
+            for (unsigned int b: getCandidates(a))
+                if (b != a && tour.contains(b)) neighbours.push_back(b);
+        } else {
+            nearest.clear();
+            distanceMatrix.forEachInRow(a, [&](unsigned int b, double l) {
+                if (l == constants::INF || !tour.contains(b)) return;
+                if (nearest.size() < REPAIR_CANDIDATES) {
+                    nearest.emplace_back(l, b);
+                    std::push_heap(nearest.begin(), nearest.end());
+                } else if (l < nearest.front().first) {
+                    std::pop_heap(nearest.begin(), nearest.end());
+                    nearest.back() = {l, b};
+                    std::push_heap(nearest.begin(), nearest.end());
+                }
+            });
+            std::sort_heap(nearest.begin(), nearest.end());
+            for (auto &[l, b]: nearest) neighbours.push_back(b);
+        }
+
+        for (unsigned int b: neighbours) {
+            unsigned int i = tour.positionOf(a), p = tour.positionOf(b);
+            //2-opt: reverse what lies between a and b, on either side, so that they become adjacent
+            unsigned int low = std::min(i, p), high = std::max(i, p);
+            if (high - low > 1) {
+                unsigned int first = low + 1, last = high;
+                double delta = tour.twoOptDelta(first, last, length);
+                if (!(delta < -IMPROVEMENT_EPSILON)) {
+                    first = low, last = high - 1;
+                    delta = tour.twoOptDelta(first, last, length);
+                }
+                if (delta < -IMPROVEMENT_EPSILON) {
+                    for (unsigned int v: {tour[tour.previous(first)], tour[first], tour[last], tour[tour.next(last)]})
+                        activate(v);
+                    tour.twoOpt(first, last, delta);
+                    break;
+                }
+            }
+            //or-opt: move the segment starting at a to either side of b, in either direction
+            bool moved = false;
+            for (unsigned int j = i; j < std::min(n, i + 3) && !moved; j++)
+                for (unsigned int at: {p, tour.previous(p)})
+                    for (bool reversed: {false, true}) {
+                        if (moved || (at >= i && at <= j) || at == tour.previous(i)) continue;
+                        double delta = tour.orOptDelta(i, j, at, reversed, length);
+                        if (!(delta < -IMPROVEMENT_EPSILON)) continue;
+                        for (unsigned int v: {tour[tour.previous(i)], tour[i], tour[j], tour[tour.next(j)], tour[at],
+                                              tour[tour.next(at)]})
+                            activate(v);
+                        tour.orOpt(i, j, at, reversed, delta);
+                        moved = true;
+                    }
+            if (moved) break;
+        }
+    }
 }
 
-double Graph::getTourDistance() const {
-    return tour.distance;
+/**
+ * Changes the length of an edge, as addBidirectionalEdge does, and repairs a tour around its ends
+ * If the closure was built, the route of the edge becomes the edge itself; the other closed lengths aren't updated
+ * Time Complexity: O(REPAIR_STEPS * (k + |V|)) (see repairTour)
+ * @param source - Dense id of one end
+ * @param dest - Dense id of the other end
+ * @param length - New length (constants::INF to remove the edge)
+ * @param tour - Tour through the graph, whose length is kept up to date
+ */
+void Graph::updateEdge(const unsigned int &source, const unsigned int &dest, double length, Tour &tour) {
+    if (source == dest) return;
+    double old = findEdge(source, dest);
+    //Kept exact, as prim and boruvka choose between their dense and sparse versions by it
+    bool existed = distanceMatrix.get(source, dest) != constants::INF, exists = length != constants::INF;
+    if (exists && !existed) totalEdges++;
+    else if (existed && !exists) totalEdges--;
+    distanceMatrix.set(source, dest, length);
+    adjacencyValid.store(false, std::memory_order_relaxed);
+    if (!closureVia.empty()) closureVia[closureIndex(source, dest)] = constants::NO_VERTEX;
+
+    if (!tour.contains(source) || !tour.contains(dest)) return;
+    unsigned int i = tour.positionOf(source), j = tour.positionOf(dest);
+    unsigned int uses = (tour.next(i) == j) + (tour.next(j) == i); //Twice in a tour of two stops
+    if (uses != 0) tour.setLength(tour.getLength() + uses * (findEdge(source, dest) - old));
+    repairTour(tour, {source, dest});
 }
 
+/**
+ * Adds a stop to a tour where its two new edges are shortest (see getInsertionEdges, here also trying the closing
+ * edge), then repairs the tour around it
+ * The stop must already be in the graph, with its edges (see addVertex and addBidirectionalEdge)
+ * Time Complexity: O(|V|) plus the repair (see repairTour)
+ * @param id - Dense id of the stop
+ * @param tour - Tour to add it to
+ */
+void Graph::insertStop(const unsigned int &id, Tour &tour) const {
+    if (tour.contains(id)) return;
+    auto length = [this](unsigned int a, unsigned int b) { return findEdge(a, b); };
+    unsigned int n = tour.size();
+    if (n < 3) {
+        tour.append(id, 0);
+        tour.computeLength(length);
+        return;
+    }
+    //Unknown lengths (findEdge without an edge or coordinates) never make a position look cheaper
+    auto cost = [&](unsigned int a, unsigned int b) {
+        double l = length(a, b);
+        return l < 0 ? constants::INF : l;
+    };
+    std::pair<std::vector<unsigned int>, double> insertionEdges = getInsertionEdges(tour, id);
+    double closing = cost(tour[n - 1], id) + cost(id, tour[0]);
+    //Without any way to connect the stop, it still goes before the first one, so the tour stays whole
+    if (closing < insertionEdges.second || insertionEdges.first.empty())
+        insertionEdges = {{tour[n - 1], id, tour[0]}, closing};
+    unsigned int before = insertionEdges.first[0], after = insertionEdges.first[2];
+    //Measured with findEdge, as the other updates and computeLength do, so the cached length stays in step
+    double delta = length(before, id) + length(id, after) - length(before, after);
+    tour.insert(after == tour[0] ? n : tour.positionOf(after), id, delta);
+    repairTour(tour, {before, id, after});
+}
 
+/**
+ * Removes a stop from a tour, joining its two neighbours, then repairs the tour around them
+ * The stop stays in the graph
+ * Time Complexity: O(|V|) plus the repair (see repairTour)
+ * @param id - Dense id of the stop
+ * @param tour - Tour to remove it from
+ */
+void Graph::removeStop(const unsigned int &id, Tour &tour) const {
+    if (!tour.contains(id)) return;
+    auto length = [this](unsigned int a, unsigned int b) { return findEdge(a, b); };
+    unsigned int i = tour.positionOf(id);
+    if (tour.size() <= 3) {
+        tour.remove(i, 0);
+        tour.computeLength(length);
+        return;
+    }
+    unsigned int before = tour[tour.previous(i)], after = tour[tour.next(i)];
+    tour.remove(i, length(before, after) - length(before, id) - length(id, after));
+    repairTour(tour, {before, after});
+}
@@ -2,77 +2,338 @@
 #define TRAVELLINGSALESMAN_GRAPH_H
 
 #include <vector>
-#include <memory>
-#include <list>
+#include <optional>
+#include <queue>
+#include <cmath>
+#include <tuple>
+#include <algorithm>
+#include <span>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <functional>
+#include <numeric>
 #include "UFDS.h"
-#include "vertex.h"
+#include "idMap.h"
+#include "distanceMatrix.h"
+#include "indexedHeap.h"
+#include "constants.h"
 #include "coordinates.h"
+#include "tour.h"
+#include "solveContext.h"
+#include "incumbent.h"
+#include "xoshiro.h"
 
+/**
+ * Graph of the stops and the lengths of the edges between them
+ * Solvers are const and keep their scratch state in a SolveContext, so once the graph is loaded any number of runs
+ * may use it at the same time; loading and other non-const calls must not overlap with them
+ */
 class Graph {
   protected:
-    struct tour_t {
-        double distance;
-        std::list<std::shared_ptr<Vertex>> course;
-    };
-
-    tour_t tour = {0, {}};
     unsigned int totalEdges = 0;
-    std::vector<std::shared_ptr<Vertex>> vertexSet;    // vertex set
-    std::vector<std::vector<bool>> selectedEdges;
-    std::vector<std::vector<double>> distanceMatrix;
+    // vertex set, stored as one array per attribute and indexed by dense id
+    std::vector<Coordinates> coordinates;
+    IdMap ids; // dataset id <-> dense id
+    DistanceMatrix distanceMatrix;
+    std::vector<unsigned int> candidates; // k nearest neighbours of each vertex, stored contiguously
+    unsigned int candidatesPerVertex = 0;
+    // adjacency lists in CSR form: the neighbours of v are at [adjacencyOffsets[v], adjacencyOffsets[v + 1])
+    // (built lazily by the first solver that needs them)
+    mutable std::vector<unsigned int> adjacencyOffsets;
+    mutable std::vector<unsigned int> adjacencyTargets;
+    mutable std::vector<double> adjacencyLengths;
+    mutable std::atomic<bool> adjacencyValid = false;
+    mutable std::mutex adjacencyMutex;
+    // a stop on a shortest path between each pair of stops, or constants::NO_VERTEX if it is the direct edge, stored
+    // as a lower triangle row by row (filled by buildMetricClosure)
+    std::vector<unsigned int> closureVia;
+    unsigned int threadCount = 1;
+    mutable SolveContextPool contexts; // scratch state for the calls that don't pass their own context
+    // cheapest edges each vertex remembers between Borůvka rounds, so it rarely has to be scanned again
+    static const unsigned int BORUVKA_CACHED_EDGES = 16;
+
+    double rootTree(const std::vector<std::tuple<unsigned int, unsigned int, double>> &treeEdges,
+                    SolveContext &context, unsigned int root) const;
+
+    template<typename Adjust>
+    double primTree(SolveContext &context, unsigned int root, Adjust adjust) const;
+
+    template<typename Adjust>
+    double boruvkaTree(SolveContext &context, unsigned int threads, unsigned int root, bool sparse,
+                       Adjust adjust) const;
+
+    void updateTourDistances(unsigned int id, std::vector<bool> &inTour, std::vector<double> &tourDistance) const;
+
+    unsigned int nearestNeighbours(unsigned int k, const std::vector<double> &penalties,
+                                   std::vector<unsigned int> &neighbours) const;
+
+    void buildSubgraph(std::span<const unsigned int> stops, Graph &subgraph) const;
+
+    static void floydWarshall(std::vector<double> &dist, std::vector<unsigned int> &via, unsigned int n,
+                              unsigned int threads);
+
+    void closureDijkstra(unsigned int threads);
+
+    void repairTour(Tour &tour, std::vector<unsigned int> active) const;
+
+    Tour clusterTour(SolveContext &context) const;
 
   public:
+    struct portfolio_t {
+        Tour tour;
+        std::string engine; // solver that found the tour
+        bool optimal = false;
+    };
+
+    struct annealing_t {
+        enum class Cooling {
+            EXPONENTIAL, // from the initial to the final temperature, geometrically over the budget
+            LAM          // adapts the temperature so the share of accepted moves follows the modified Lam schedule
+        };
+        Cooling cooling = Cooling::LAM;
+        unsigned int chains = 0;        // chains run in parallel (0 for the graph's thread count)
+        unsigned int candidates = 8;    // nearest neighbours a vertex may be joined to by a move
+        double initialAcceptance = 0.5; // probability of accepting an average increase in length at the start
+        double finalTemperature = 1e-3; // last temperature of the exponential schedule, relative to the first
+        uint64_t seed = 0;              // 0 for a random seed
+    };
+
+    struct genetic_t {
+        unsigned int islands = 0;            // islands evolved in parallel (0 for the graph's thread count)
+        unsigned int populationSize = 32;    // tours per island
+        unsigned int migrationInterval = 64; // generations between migrations
+        double mutationRate = 0.2;           // probability of a random 2-opt move on each child
+        bool localSearch = true;             // whether children are improved by 2-opt descent
+        unsigned int candidates = 8;         // nearest neighbours tried by the descent
+        uint64_t seed = 0;                   // 0 for a random seed
+    };
+
+    struct colony_iteration_t {
+        unsigned long iteration;
+        double milliseconds; // wall time of the iteration
+        double elapsed;       // wall time since the search started, in milliseconds
+        double iterationBest; // length of the best tour built in the iteration
+        double best;          // length of the best tour so far
+    };
+
+    struct colony_t {
+        unsigned int ants = 16;         // tours built per iteration
+        unsigned int threads = 0;       // threads building them (0 for the graph's thread count)
+        unsigned int candidates = 15;   // nearest neighbours of each vertex whose edges carry pheromone
+        double alpha = 1;               // weight of the pheromone
+        double beta = 2;                // weight of the inverse of the length
+        double evaporation = 0.02;      // share of the pheromone that evaporates every iteration
+        bool localSearch = true;        // whether every ant's tour is improved by 2-opt descent
+        uint64_t seed = 0;              // 0 for a random seed
+        std::function<void(const colony_iteration_t &)> onIteration; // called after every iteration, if set
+    };
+
+    struct cluster_t {
+        enum class Partition {
+            KMEANS, // Lloyd's algorithm on the positions of the stops on the sphere, seeded by k-means++
+            GRID    // cells of equal latitude and longitude span over the area the stops cover
+        };
+        Partition partition = Partition::KMEANS;
+        unsigned int clusterSize = 200; // stops per cluster, on average
+        unsigned int threads = 0;       // clusters solved in parallel (0 for the graph's thread count)
+        uint64_t seed = 0;              // seeds k-means++ (0 for a random seed)
+    };
+
+    struct lower_bound_t {
+        double bound; // no tour is shorter (constants::INF if no tour exists)
+        std::vector<double> penalties; // node penalties that gave the bound
+        unsigned int iterations;
+    };
+
+    struct neighbours_t {
+        const unsigned int *lists; // neighbours of each vertex, nearest first, a list every stride entries
+        unsigned int k;            // neighbours used from each list
+        unsigned int stride;
+
+        [[nodiscard]] const unsigned int *of(unsigned int v) const { return lists + (size_t) v * stride; }
+    };
+
+    // largest graph on which the portfolio also runs backtracking
+    static const unsigned int EXACT_PORTFOLIO_LIMIT = 25;
+    // Held-Karp iterations by default, iterations without improvement before the step is halved,
+    // and the step at which the search stops
+    static const unsigned int HELD_KARP_ITERATIONS = 100;
+    static const unsigned int HELD_KARP_PATIENCE = 5;
+    static constexpr double HELD_KARP_MIN_STEP = 1e-3;
+    // simulated annealing: moves sampled to set the starting temperature, moves between budget checks and,
+    // without a budget, moves per vertex before the schedule starts over
+    static const unsigned int ANNEALING_SAMPLE = 1000;
+    static const unsigned int ANNEALING_EPOCH = 1024;
+    static const unsigned int ANNEALING_CYCLE = 20000;
+    // genetic algorithm: nearest insertion tours among the seeds of each island, and random 2-opt moves applied to
+    // copies of them to seed the rest of the island
+    static const unsigned int GENETIC_SEEDS = 4;
+    static const unsigned int GENETIC_SEED_MUTATIONS = 8;
+    // smallest decrease in length that local search counts as an improvement
+    static constexpr double IMPROVEMENT_EPSILON = 1e-9;
+    // ant colony: probability that an ant rebuilds the best tour once the pheromone has converged (sets tauMin),
+    // iterations between deposits by the best tour so far, and iterations without improvement before a reset
+    static constexpr double COLONY_BEST_PROBABILITY = 0.05;
+    static const unsigned int COLONY_GLOBAL_INTERVAL = 10;
+    static const unsigned int COLONY_STAGNATION = 200;
+    // clustering: largest cluster solved exactly, nearest neighbours tried by the 2-opt descent of larger ones,
+    // most k-means iterations, and passes that move the points where consecutive clusters are joined
+    static const unsigned int CLUSTER_EXACT_LIMIT = 10;
+    static const unsigned int CLUSTER_CANDIDATES = 8;
+    static const unsigned int KMEANS_ITERATIONS = 25;
+    static const unsigned int CLUSTER_STITCH_PASSES = 3;
+    // largest graph whose metric closure is built by Floyd–Warshall (Dijkstra from every stop above), and the side of
+    // the blocks it works on, sized so the three blocks it reads and writes fit in the L2 cache
+    static const unsigned int FLOYD_WARSHALL_LIMIT = 1500;
+    static const unsigned int FLOYD_WARSHALL_BLOCK = 64;
+    // tour repair: nearest neighbours tried around each stop, and stops examined per repair
+    static const unsigned int REPAIR_CANDIDATES = 8;
+    static const unsigned int REPAIR_STEPS = 64;
+    // nearest neighbours per vertex in the candidate lists built when a graph is loaded, as many as the engines use
+    // by default (the ant colony's)
+    static const unsigned int CANDIDATE_LIST_SIZE = 15;
+
     Graph();
 
-    [[nodiscard]] double findEdge(const std::shared_ptr<Vertex> &v1, const std::shared_ptr<Vertex> &v2) const;
+    [[nodiscard]] double findEdge(const unsigned int &v1id, const unsigned int &v2id) const;
 
     [[nodiscard]] unsigned int getNumVertex() const;
 
-    [[nodiscard]] std::vector<std::shared_ptr<Vertex>> getVertexSet() const;
-
     [[nodiscard]] unsigned int getTotalEdges() const;
 
-    [[nodiscard]] std::shared_ptr<Vertex> findVertex(const unsigned int &id) const;
+    [[nodiscard]] std::optional<unsigned int> findVertexByExternalId(const unsigned int &externalId) const;
+
+    [[nodiscard]] unsigned int getExternalId(const unsigned int &id) const;
+
+    [[nodiscard]] const Coordinates &getCoordinates(const unsigned int &id) const;
 
-    std::shared_ptr<Vertex> addVertex(const unsigned int &id, Coordinates c = {0, 0});
+    void setCoordinates(const unsigned int &id, const Coordinates &c);
+
+    unsigned int addVertex(const unsigned int &externalId, Coordinates c = {0, 0});
 
     void addBidirectionalEdge(const unsigned int &source, const unsigned int &dest, double length);
 
-    void visitedDFS(const std::shared_ptr<Vertex> &source);
+    void visitedDFS(const unsigned int &source, SolveContext &context) const;
+
+    int addToTour(Tour &tour, const unsigned int &stop) const;
+
+    int preorderMSTTraversal(const unsigned int &source, Tour &tour, SolveContext &context) const;
+
+    double prim(SolveContext &context) const;
 
-    int addToTour(const std::shared_ptr<Vertex>& stop);
+    double primDense(SolveContext &context) const;
 
-    int preorderMSTTraversal(const std::shared_ptr<Vertex>& source);
+    double primSparse(SolveContext &context) const;
 
-    void prim();
+    double boruvka(SolveContext &context, unsigned int threads = 0) const;
 
-    void triangularTSPTour();
+    void buildAdjacency() const;
 
-    void printTour();
+    [[nodiscard]] Tour triangularTSPTour() const;
 
-    std::pair<double, std::vector<unsigned int>> tspBT();
+    Tour triangularTSPTour(SolveContext &context) const;
+
+    [[nodiscard]] Tour tspBT() const;
+
+    Tour tspBT(SolveContext &context, Incumbent *shared = nullptr) const;
 
 
     [[nodiscard]] std::pair<std::vector<unsigned int>, double>
-    getInsertionEdges(std::vector<unsigned int> tour, unsigned int newVertexId) const;
+    getInsertionEdges(const Tour &tour, unsigned int newVertexId) const;
+
+    [[nodiscard]] Tour nearestInsertionHeuristic(const unsigned int &start) const;
 
-    std::pair<double, std::vector<unsigned int>> nearestInsertionHeuristic(unsigned int &start);
+    Tour nearestInsertionHeuristic(const unsigned int &start, SolveContext &context) const;
 
     void clearGraph();
 
-    std::pair<unsigned int, unsigned int> getNextHeuristicEdge(std::vector<unsigned int> tour, UFDS tourSets);
+    static unsigned int getNextHeuristicVertex(const std::vector<bool> &inTour, const std::vector<double> &tourDistance);
+
+    void setDistanceStorage(DistanceMatrix::Layout layout,
+                            DistanceMatrix::Precision precision = DistanceMatrix::Precision::DOUBLE,
+                            double scale = 100, const std::string &backingDirectory = "");
+
+    [[nodiscard]] double getDistanceMaxError(double length, unsigned int edges) const;
+
+    [[nodiscard]] size_t getDistanceMemoryUsage() const;
+
+    void setThreadCount(unsigned int threads);
+
+    [[nodiscard]] unsigned int getThreadCount() const;
+
+    double oneTree(const std::vector<double> &penalties, SolveContext &context) const;
+
+    [[nodiscard]] lower_bound_t heldKarpBound(unsigned int iterations = HELD_KARP_ITERATIONS,
+                                              double upperBound = constants::INF) const;
+
+    void buildCandidateLists(unsigned int k, const std::vector<double> &penalties = {});
+
+    [[nodiscard]] std::span<const unsigned int> getCandidates(unsigned int id) const;
+
+    neighbours_t neighbourLists(unsigned int k, std::vector<unsigned int> &storage) const;
+
+    [[nodiscard]] bool isComplete() const;
+
+    void buildMetricClosure();
+
+    [[nodiscard]] bool hasMetricClosure() const;
+
+    [[nodiscard]] std::vector<unsigned int> expandPath(unsigned int source, unsigned int dest) const;
+
+    [[nodiscard]] std::vector<unsigned int> expandTour(const Tour &tour) const;
+
+    void updateEdge(const unsigned int &source, const unsigned int &dest, double length, Tour &tour);
 
-    [[nodiscard]] double getTourDistance() const;
+    void insertStop(const unsigned int &id, Tour &tour) const;
 
-    static void printTour(const std::vector<unsigned int>& tour);
+    void removeStop(const unsigned int &id, Tour &tour) const;
 
-    void printTour(unsigned int *tour);
+    void printTour(const Tour &tour) const;
 
     static bool inSolution(unsigned int j, const std::vector<unsigned int>& solution, unsigned int n);
 
-    void
-    tspRecursion(std::vector<unsigned int> &currentSolution, double currentSolutionDist, unsigned int currentNodeIdx,
-                 double &bestSolutionDist, std::vector<unsigned int> &bestSolution, unsigned int n);
+    bool tspRecursion(SolveContext &context, double currentSolutionDist, unsigned int currentNodeIdx,
+                      double &bestSolutionDist, unsigned int n, Incumbent *shared) const;
+
+    void nearestInsertionSearch(Incumbent &incumbent, SolveContext &context) const;
+
+    void portfolioSearch(Incumbent &incumbent) const;
+
+    void annealingSearch(Incumbent &incumbent, const annealing_t &options) const;
+
+    void annealChain(Incumbent &incumbent, const annealing_t &options, const neighbours_t &neighbours,
+                     Xoshiro256 generator, SolveContext &context) const;
+
+    [[nodiscard]] Tour simulatedAnnealing(std::chrono::milliseconds budget) const;
+
+    [[nodiscard]] Tour simulatedAnnealing(std::chrono::milliseconds budget, const annealing_t &options) const;
+
+    void twoOptDescent(Tour &tour, const neighbours_t &neighbours, SolveContext &context) const;
+
+    static void orderCrossover(std::span<const unsigned int> first, std::span<const unsigned int> second,
+                               std::span<unsigned int> child, std::vector<bool> &taken, Xoshiro256 &generator);
+
+    void geneticSearch(Incumbent &incumbent, const genetic_t &options) const;
+
+    [[nodiscard]] Tour geneticAlgorithm(std::chrono::milliseconds budget) const;
+
+    [[nodiscard]] Tour geneticAlgorithm(std::chrono::milliseconds budget, const genetic_t &options) const;
+
+    void antColonySearch(Incumbent &incumbent, const colony_t &options) const;
+
+    [[nodiscard]] Tour antColony(std::chrono::milliseconds budget) const;
+
+    [[nodiscard]] Tour antColony(std::chrono::milliseconds budget, const colony_t &options) const;
+
+    [[nodiscard]] std::vector<std::vector<unsigned int>> clusterStops(const cluster_t &options) const;
+
+    [[nodiscard]] Tour clusteredTSPTour() const;
+
+    [[nodiscard]] Tour clusteredTSPTour(const cluster_t &options) const;
+
+    [[nodiscard]] portfolio_t portfolioTSPTour(std::chrono::milliseconds budget) const;
 };
 
 #endif //TRAVELLINGSALESMAN_GRAPH_H
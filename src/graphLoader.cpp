@@ -0,0 +1,94 @@
+#include "graphLoader.h"
+#include <fstream>
+#include <charconv>
+#include <tuple>
+#include <vector>
+#include "instrumentation.h"
+
+/**
+ * Parses the first three comma-separated fields of a line as an unsigned id and two numbers
+ * Time Complexity: O(length of the line)
+ * @return false if the line doesn't start with three numbers
+ */
+bool GraphLoader::parseFields(std::string_view line, unsigned int &id, double &first, double &second) {
+    const char *end = line.data() + line.size();
+    auto [afterId, idError] = std::from_chars(line.data(), end, id);
+    if (idError != std::errc() || afterId == end || *afterId != ',') return false;
+    auto [afterFirst, firstError] = std::from_chars(afterId + 1, end, first);
+    if (firstError != std::errc() || afterFirst == end || *afterFirst != ',') return false;
+    auto [afterSecond, secondError] = std::from_chars(afterFirst + 1, end, second);
+    return secondError == std::errc() && (afterSecond == end || *afterSecond == ',' || *afterSecond == '\r');
+}
+
+/**
+ * Adds the edges of an edges file to a graph, and their ends as vertices
+ * Lines are parsed LOAD_BATCH at a time before their edges are added, so the two phases can be timed apart
+ * Time Complexity: O(n), where n is the number of lines of the file
+ * @param graph - Graph that receives the edges
+ * @param filename - Path of the edges file
+ * @return false if the file couldn't be opened
+ */
+bool GraphLoader::loadEdges(Graph &graph, const std::string &filename) {
+    std::ifstream edges(filename);
+    if (!edges.is_open()) return false;
+    std::string line;
+    std::vector<std::tuple<unsigned int, unsigned int, double>> batch;
+    batch.reserve(LOAD_BATCH);
+    while (edges) {
+        {
+            instrumentation::Scope phase(instrumentation::Phase::PARSING);
+            batch.clear();
+            unsigned int origin;
+            double destination, distance;
+            while (batch.size() < LOAD_BATCH && std::getline(edges, line))
+                if (parseFields(line, origin, destination, distance))
+                    batch.emplace_back(origin, (unsigned int) destination, distance);
+        }
+        instrumentation::Scope phase(instrumentation::Phase::MATRIX_FILL);
+        for (auto [origin, destination, distance]: batch) {
+            //Dataset ids are remapped to dense ids, so storage grows with the number of vertices only
+            unsigned int source = graph.addVertex(origin);
+            unsigned int dest = graph.addVertex(destination);
+            graph.addBidirectionalEdge(source, dest, distance);
+        }
+    }
+    return true;
+}
+
+/**
+ * Sets the coordinates of the vertices listed in a nodes file, adding the ones the graph doesn't have yet
+ * Time Complexity: O(n), where n is the number of lines of the file
+ * @param graph - Graph that receives the coordinates
+ * @param filename - Path of the nodes file
+ * @param onNode - Function called with every node read, if set
+ * @return false if the file couldn't be opened
+ */
+bool GraphLoader::loadNodes(Graph &graph, const std::string &filename, const NodeCallback &onNode) {
+    std::ifstream nodes(filename);
+    if (!nodes.is_open()) return false;
+    instrumentation::Scope phase(instrumentation::Phase::PARSING);
+    std::string line;
+    unsigned int id;
+    double longitude, latitude;
+    while (std::getline(nodes, line)) {
+        if (!parseFields(line, id, longitude, latitude)) continue;
+        auto vertex = graph.findVertexByExternalId(id);
+        if (!vertex) graph.addVertex(id, {latitude, longitude});
+        else graph.setCoordinates(*vertex, {latitude, longitude});
+        if (onNode) onNode(id, latitude, longitude);
+    }
+    return true;
+}
+
+/**
+ * Loads an instance: its edges, then the coordinates of its nodes if it has a nodes file
+ * Time Complexity: O(n + v), where n is the number of lines of the edges file and v of the nodes file
+ * @param graph - Graph that receives the instance
+ * @param edgesFilename - Path of the edges file
+ * @param nodesFilename - Path of the nodes file, or empty if there is none
+ * @return false if a file couldn't be opened
+ */
+bool GraphLoader::load(Graph &graph, const std::string &edgesFilename, const std::string &nodesFilename) {
+    if (!loadEdges(graph, edgesFilename)) return false;
+    return nodesFilename.empty() || loadNodes(graph, nodesFilename);
+}
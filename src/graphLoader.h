@@ -0,0 +1,32 @@
+#ifndef TRAVELLINGSALESMAN_GRAPHLOADER_H
+#define TRAVELLINGSALESMAN_GRAPHLOADER_H
+
+#include <string>
+#include <string_view>
+#include <functional>
+#include "graph.h"
+
+/**
+ * Reads the dataset files into a Graph
+ * Edges files have one "origin,destination,distance" per line, optionally followed by labels, and nodes files one
+ * "id,longitude,latitude" per line; lines that don't start with those numbers (headers) are skipped, so every dataset
+ * layout is read the same way
+ */
+class GraphLoader {
+  private:
+    static const unsigned int LOAD_BATCH = 4096; // lines parsed before their edges are added
+
+    static bool parseFields(std::string_view line, unsigned int &id, double &first, double &second);
+
+  public:
+    using NodeCallback = std::function<void(unsigned int id, double latitude, double longitude)>;
+
+    static bool loadEdges(Graph &graph, const std::string &filename);
+
+    static bool loadNodes(Graph &graph, const std::string &filename, const NodeCallback &onNode = {});
+
+    static bool load(Graph &graph, const std::string &edgesFilename, const std::string &nodesFilename = "");
+};
+
+
+#endif //TRAVELLINGSALESMAN_GRAPHLOADER_H
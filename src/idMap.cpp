@@ -0,0 +1,96 @@
+#include "idMap.h"
+
+IdMap::IdMap() = default;
+
+/**
+ * Finds the slot where an external id is stored, or the empty slot where it would be inserted
+ * Time Complexity: O(1) (average case) | O(n) (worst case)
+ * @param externalId - Id as read from the dataset
+ * @return Index of the slot
+ */
+size_t IdMap::slotOf(unsigned int externalId) const {
+    size_t mask = keys.size() - 1;
+    //Fibonacci hashing spreads consecutive ids across the table
+    size_t slot = (size_t) ((externalId * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+    while (values[slot] != 0 && keys[slot] != externalId) slot = (slot + 1) & mask;
+    return slot;
+}
+
+/**
+ * Rebuilds the table with a new capacity (must be a power of two)
+ * Time Complexity: O(n)
+ * @param newCapacity - Number of slots of the new table
+ */
+void IdMap::rehash(size_t newCapacity) {
+    keys.assign(newCapacity, 0);
+    values.assign(newCapacity, 0);
+    for (unsigned int i = 0; i < externalIds.size(); i++) {
+        size_t slot = slotOf(externalIds[i]);
+        keys[slot] = externalIds[i];
+        values[slot] = i + 1;
+    }
+}
+
+/**
+ * Returns the dense index of an external id, assigning the next free one if the id wasn't seen before
+ * Time Complexity: O(1) (amortized average case)
+ * @param externalId - Id as read from the dataset
+ * @return Dense index of the id
+ */
+unsigned int IdMap::insert(unsigned int externalId) {
+    //Keep the load factor under 1/2
+    if ((externalIds.size() + 1) * 2 > keys.size()) rehash(keys.empty() ? 16 : keys.size() * 2);
+
+    size_t slot = slotOf(externalId);
+    if (values[slot] != 0) return values[slot] - 1;
+
+    keys[slot] = externalId;
+    values[slot] = (unsigned int) externalIds.size() + 1;
+    externalIds.push_back(externalId);
+    return values[slot] - 1;
+}
+
+/**
+ * Finds the dense index of an external id
+ * Time Complexity: O(1) (average case)
+ * @param externalId - Id as read from the dataset
+ * @return Dense index of the id, or std::nullopt if the id is unknown
+ */
+std::optional<unsigned int> IdMap::find(unsigned int externalId) const {
+    if (keys.empty()) return std::nullopt;
+    size_t slot = slotOf(externalId);
+    if (values[slot] == 0) return std::nullopt;
+    return values[slot] - 1;
+}
+
+/**
+ * Translates a dense index back into the id used in the dataset
+ * Time Complexity: O(1)
+ * @param internalId - Dense index
+ * @return External id
+ */
+unsigned int IdMap::toExternal(unsigned int internalId) const {
+    return externalIds[internalId];
+}
+
+unsigned int IdMap::size() const {
+    return (unsigned int) externalIds.size();
+}
+
+/**
+ * Prepares the table to hold n ids without rehashing
+ * Time Complexity: O(n)
+ * @param n - Expected number of ids
+ */
+void IdMap::reserve(unsigned int n) {
+    size_t capacity = 16;
+    while (capacity < (size_t) n * 2) capacity *= 2;
+    if (capacity > keys.size()) rehash(capacity);
+    externalIds.reserve(n);
+}
+
+void IdMap::clear() {
+    keys = {};
+    values = {};
+    externalIds = {};
+}
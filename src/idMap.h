@@ -0,0 +1,38 @@
+#ifndef TRAVELLINGSALESMAN_IDMAP_H
+#define TRAVELLINGSALESMAN_IDMAP_H
+
+#include <vector>
+#include <optional>
+
+/**
+ * Translates the (possibly sparse or very large) ids found in the dataset files into dense indices 0..n-1
+ * Uses open addressing with linear probing over two flat arrays, so lookups never allocate
+ */
+class IdMap {
+  private:
+    std::vector<unsigned int> keys;    // external id stored at each slot
+    std::vector<unsigned int> values;  // dense index + 1 stored at each slot (0 marks an empty slot)
+    std::vector<unsigned int> externalIds; // external id of each dense index
+
+    [[nodiscard]] size_t slotOf(unsigned int externalId) const;
+
+    void rehash(size_t newCapacity);
+
+  public:
+    IdMap();
+
+    unsigned int insert(unsigned int externalId);
+
+    [[nodiscard]] std::optional<unsigned int> find(unsigned int externalId) const;
+
+    [[nodiscard]] unsigned int toExternal(unsigned int internalId) const;
+
+    [[nodiscard]] unsigned int size() const;
+
+    void reserve(unsigned int n);
+
+    void clear();
+};
+
+
+#endif //TRAVELLINGSALESMAN_IDMAP_H
@@ -0,0 +1,123 @@
+#include "incumbent.h"
+#include <utility>
+#include <algorithm>
+
+/**
+ * @param deadline - Time at which the solvers must stop
+ * @param iterationBudget - Number of iterations after which the solvers must stop
+ * @param onImprovement - Function called with every new best tour, one call at a time from the thread of the solver
+ * that found it, while the incumbent is locked (so it must not call the incumbent back)
+ */
+Incumbent::Incumbent(std::chrono::steady_clock::time_point deadline, unsigned long iterationBudget,
+                     Callback onImprovement)
+        : onImprovement(std::move(onImprovement)), iterationBudget(iterationBudget),
+          start(std::chrono::steady_clock::now()), deadline(deadline) {}
+
+/**
+ * Keeps a tour if it is shorter than the best one so far, and reports it to the improvement callback
+ * Time Complexity: O(1) if the tour isn't kept | O(|V|) if it is
+ * @param tour - Candidate tour
+ * @param engineName - Name of the solver that found it
+ * @return true if the tour became the best one
+ */
+bool Incumbent::offer(const Tour &tour, const std::string &engineName) {
+    if (tour.empty() || !(tour.getLength() < getLength())) return false;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!(tour.getLength() < bestLength.load(std::memory_order_relaxed))) return false;
+    best = {tour, engineName, getElapsed()};
+    bestLength.store(tour.getLength(), std::memory_order_relaxed);
+    if (onImprovement) onImprovement(best);
+    return true;
+}
+
+/**
+ * @return Length of the best tour so far (infinite if there is none), without locking
+ */
+double Incumbent::getLength() const {
+    return bestLength.load(std::memory_order_relaxed);
+}
+
+/**
+ * @return Copy of the best tour so far, with the engine that found it and when (an empty tour if there is none)
+ */
+Improvement Incumbent::getBest() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return best;
+}
+
+Tour Incumbent::getTour() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return best.tour;
+}
+
+/**
+ * @return Name of the engine that found the best tour (empty if there is none)
+ */
+std::string Incumbent::getEngine() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return best.engine;
+}
+
+/**
+ * @return Milliseconds since the incumbent was created
+ */
+double Incumbent::getElapsed() const {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Counts iterations done by a solver against the shared budget
+ * @param count - Number of iterations done
+ * @return true if the solver may go on (same as !expired())
+ */
+bool Incumbent::charge(unsigned long count) {
+    iterations.fetch_add(count, std::memory_order_relaxed);
+    return !expired();
+}
+
+unsigned long Incumbent::getIterations() const {
+    return iterations.load(std::memory_order_relaxed);
+}
+
+/**
+ * @return Fraction of the time or iteration budget spent, whichever is larger, in [0, 1]
+ * (negative if there is neither a deadline nor an iteration budget)
+ */
+double Incumbent::getProgress() const {
+    double progress = -1;
+    if (deadline != std::chrono::steady_clock::time_point::max())
+        progress = std::chrono::duration<double>(std::chrono::steady_clock::now() - start) /
+                   std::chrono::duration<double>(deadline - start);
+    if (iterationBudget != std::numeric_limits<unsigned long>::max())
+        progress = std::max(progress, (double) getIterations() / (double) iterationBudget);
+    return std::min(progress, 1.0);
+}
+
+/**
+ * Asks every solver sharing this incumbent to stop as soon as possible
+ */
+void Incumbent::stop() {
+    stopRequested.store(true, std::memory_order_relaxed);
+}
+
+/**
+ * Records that no tour shorter than the best one exists, which also stops the other solvers
+ */
+void Incumbent::proveOptimal() {
+    optimal.store(true, std::memory_order_relaxed);
+    stop();
+}
+
+bool Incumbent::isOptimal() const {
+    return optimal.load(std::memory_order_relaxed);
+}
+
+/**
+ * @return true if the solvers should stop: a stop was requested, the best tour is optimal, or the time or the
+ * iteration budget is spent
+ */
+bool Incumbent::expired() const {
+    return stopRequested.load(std::memory_order_relaxed) ||
+           iterations.load(std::memory_order_relaxed) >= iterationBudget ||
+           std::chrono::steady_clock::now() >= deadline;
+}
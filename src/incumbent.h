@@ -0,0 +1,78 @@
+#ifndef TRAVELLINGSALESMAN_INCUMBENT_H
+#define TRAVELLINGSALESMAN_INCUMBENT_H
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <string>
+#include "constants.h"
+#include "tour.h"
+
+/**
+ * A tour found by a solver, with the engine that found it and when
+ */
+struct Improvement {
+    Tour tour;
+    std::string engine;
+    double milliseconds = 0; // time since the search started
+};
+
+/**
+ * Best tour found so far by solvers running at the same time, with the name of the engine that found it
+ * The length of the best tour can be read without locking, so exact search can prune with it at every step
+ * Also tells the solvers when to stop: at the deadline, once the iteration budget is spent, when asked to, or once a
+ * tour is proven optimal
+ * Iterations are the engines' own units of work (one search step, one heuristic run...)
+ */
+class Incumbent {
+  public:
+    using Callback = std::function<void(const Improvement &)>;
+
+  private:
+    mutable std::mutex mutex;
+    Improvement best;
+    Callback onImprovement;
+    std::atomic<double> bestLength = constants::INF;
+    std::atomic<bool> stopRequested = false;
+    std::atomic<bool> optimal = false;
+    std::atomic<unsigned long> iterations = 0;
+    unsigned long iterationBudget;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point deadline;
+
+  public:
+    explicit Incumbent(std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max(),
+                       unsigned long iterationBudget = std::numeric_limits<unsigned long>::max(),
+                       Callback onImprovement = {});
+
+    bool offer(const Tour &tour, const std::string &engineName);
+
+    [[nodiscard]] double getLength() const;
+
+    [[nodiscard]] Improvement getBest() const;
+
+    [[nodiscard]] Tour getTour() const;
+
+    [[nodiscard]] std::string getEngine() const;
+
+    [[nodiscard]] double getElapsed() const;
+
+    bool charge(unsigned long count = 1);
+
+    [[nodiscard]] unsigned long getIterations() const;
+
+    [[nodiscard]] double getProgress() const;
+
+    void stop();
+
+    void proveOptimal();
+
+    [[nodiscard]] bool isOptimal() const;
+
+    [[nodiscard]] bool expired() const;
+};
+
+
+#endif //TRAVELLINGSALESMAN_INCUMBENT_H
@@ -0,0 +1,150 @@
+#ifndef TRAVELLINGSALESMAN_INDEXEDHEAP_H
+#define TRAVELLINGSALESMAN_INDEXEDHEAP_H
+
+#include <vector>
+#include <limits>
+#include "instrumentation.h"
+
+/**
+ * Mutable min-priority queue of integer ids in [0, capacity), stored as a D-ary heap
+ * Keys live in a contiguous array parallel to the heap, so comparing the children of a node reads adjacent memory,
+ * and a side array holds the heap position of every id, so decreaseKey needs no search and no allocation
+ * Used by Graph::primSparse (dense graphs use the array-scan primDense instead) and by the Dijkstra runs of
+ * Graph::closureDijkstra
+ * Time Complexity: insert/decreaseKey O(log_D(n)) | extractMin O(D log_D(n))
+ */
+template<unsigned int D = 4, typename Key = double>
+class IndexedHeap {
+    static_assert(D >= 2, "A heap needs at least two children per node");
+
+    static constexpr unsigned int NOT_IN_HEAP = std::numeric_limits<unsigned int>::max();
+
+    std::vector<unsigned int> ids;      // id stored at each heap slot
+    std::vector<Key> keys;              // key of the id stored at each heap slot
+    std::vector<unsigned int> position; // heap slot of each id, or NOT_IN_HEAP
+
+    void place(unsigned int slot, unsigned int id, Key key) {
+        ids[slot] = id;
+        keys[slot] = key;
+        position[id] = slot;
+    }
+
+    void siftUp(unsigned int slot, unsigned int id, Key key) {
+        while (slot > 0) {
+            unsigned int parent = (slot - 1) / D;
+            if (!(key < keys[parent])) break;
+            place(slot, ids[parent], keys[parent]);
+            slot = parent;
+        }
+        place(slot, id, key);
+    }
+
+    void siftDown(unsigned int slot, unsigned int id, Key key) {
+        unsigned int size = (unsigned int) ids.size();
+        while (true) {
+            unsigned int first = slot * D + 1;
+            if (first >= size) break;
+            unsigned int last = first + D < size ? first + D : size;
+            unsigned int best = first;
+            for (unsigned int child = first + 1; child < last; child++)
+                if (keys[child] < keys[best]) best = child;
+            if (!(keys[best] < key)) break;
+            place(slot, ids[best], keys[best]);
+            slot = best;
+        }
+        place(slot, id, key);
+    }
+
+  public:
+    explicit IndexedHeap(unsigned int capacity = 0) : position(capacity, NOT_IN_HEAP) {
+        ids.reserve(capacity);
+        keys.reserve(capacity);
+    }
+
+    /**
+     * Empties the heap and makes room for ids in [0, capacity)
+     * Time Complexity: O(capacity)
+     */
+    void reset(unsigned int capacity) {
+        ids.clear();
+        keys.clear();
+        ids.reserve(capacity);
+        keys.reserve(capacity);
+        position.assign(capacity, NOT_IN_HEAP);
+    }
+
+    [[nodiscard]] bool empty() const {
+        return ids.empty();
+    }
+
+    [[nodiscard]] unsigned int size() const {
+        return (unsigned int) ids.size();
+    }
+
+    [[nodiscard]] bool contains(unsigned int id) const {
+        return position[id] != NOT_IN_HEAP;
+    }
+
+    [[nodiscard]] Key getKey(unsigned int id) const {
+        return keys[position[id]];
+    }
+
+    [[nodiscard]] unsigned int top() const {
+        return ids[0];
+    }
+
+    [[nodiscard]] Key topKey() const {
+        return keys[0];
+    }
+
+    void insert(unsigned int id, Key key) {
+        instrumentation::count(instrumentation::Counter::HEAP_INSERTS);
+        ids.push_back(id);
+        keys.push_back(key);
+        siftUp((unsigned int) ids.size() - 1, id, key);
+    }
+
+    /**
+     * Lowers the key of an id already in the heap (a larger key is ignored)
+     */
+    void decreaseKey(unsigned int id, Key key) {
+        instrumentation::count(instrumentation::Counter::HEAP_DECREASES);
+        unsigned int slot = position[id];
+        if (key < keys[slot]) siftUp(slot, id, key);
+    }
+
+    /**
+     * Inserts the id, or lowers its key if it is already in the heap
+     */
+    void insertOrDecrease(unsigned int id, Key key) {
+        contains(id) ? decreaseKey(id, key) : insert(id, key);
+    }
+
+    /**
+     * Removes the id with the smallest key
+     * @return The removed id
+     */
+    unsigned int extractMin() {
+        instrumentation::count(instrumentation::Counter::HEAP_EXTRACTIONS);
+        unsigned int min = ids[0];
+        position[min] = NOT_IN_HEAP;
+        unsigned int lastId = ids.back();
+        Key lastKey = keys.back();
+        ids.pop_back();
+        keys.pop_back();
+        if (!ids.empty()) siftDown(0, lastId, lastKey);
+        return min;
+    }
+
+    /**
+     * Empties the heap, keeping its capacity
+     * Time Complexity: O(size)
+     */
+    void clear() {
+        for (unsigned int id: ids) position[id] = NOT_IN_HEAP;
+        ids.clear();
+        keys.clear();
+    }
+};
+
+#endif //TRAVELLINGSALESMAN_INDEXEDHEAP_H
@@ -0,0 +1,122 @@
+#include "instrumentation.h"
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+namespace instrumentation {
+    static const char *const COUNTER_NAMES[COUNTERS] = {
+            "search_nodes", "search_pruned", "distance_lookups", "haversine_fallbacks", "heap_inserts",
+            "heap_decreases", "heap_extractions", "insertion_evaluations"
+    };
+
+    static const char *const PHASE_NAMES[PHASES] = {
+            "parsing", "matrix_fill", "metric_closure", "mst", "traversal", "backtracking", "insertion", "annealing",
+            "genetic", "ant_colony", "clustering"
+    };
+
+    static std::mutex mutex;
+    static std::vector<ThreadValues *> running; // values of the threads that counted something and are still running
+    static Report ended;                        // totals of the threads that ended
+
+    /**
+     * Moves the values of a thread into the totals when it ends
+     */
+    struct Registration {
+        ~Registration() {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (unsigned int c = 0; c < COUNTERS; c++) ended.counters[c] += local.counters[c].load();
+            for (unsigned int p = 0; p < PHASES; p++) {
+                ended.nanoseconds[p] += local.nanoseconds[p].load();
+                ended.calls[p] += local.calls[p].load();
+            }
+            running.erase(std::find(running.begin(), running.end(), &local));
+        }
+    };
+
+    /**
+     * Makes the values of the calling thread part of the reports, on its first update
+     */
+    void registerThread() {
+        thread_local Registration registration;
+        std::lock_guard<std::mutex> lock(mutex);
+        running.push_back(&local);
+        local.registered = true;
+    }
+
+    /**
+     * Sums the values of every thread, running or ended
+     * Time Complexity: O(threads)
+     */
+    Report collect() {
+        std::lock_guard<std::mutex> lock(mutex);
+        Report report = ended;
+        for (const ThreadValues *values: running) {
+            for (unsigned int c = 0; c < COUNTERS; c++)
+                report.counters[c] += values->counters[c].load(std::memory_order_relaxed);
+            for (unsigned int p = 0; p < PHASES; p++) {
+                report.nanoseconds[p] += values->nanoseconds[p].load(std::memory_order_relaxed);
+                report.calls[p] += values->calls[p].load(std::memory_order_relaxed);
+            }
+        }
+        return report;
+    }
+
+    /**
+     * Sets every value back to zero; updates made by threads running at the same time may be lost, so it is meant to be
+     * called between solves
+     */
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex);
+        ended = Report();
+        for (ThreadValues *values: running) {
+            for (auto &counter: values->counters) counter.store(0, std::memory_order_relaxed);
+            for (auto &nanoseconds: values->nanoseconds) nanoseconds.store(0, std::memory_order_relaxed);
+            for (auto &calls: values->calls) calls.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @return The counters, then the phases that ran with their number of calls and total time (summed over threads,
+     * so parallel phases can exceed the wall-clock time), one per line
+     */
+    std::string Report::toText() const {
+        std::string text = "Instrumentation:\n";
+        char line[128];
+        for (unsigned int c = 0; c < COUNTERS; c++) {
+            snprintf(line, sizeof line, "  %-24s %16llu\n", COUNTER_NAMES[c], (unsigned long long) counters[c]);
+            text += line;
+        }
+        for (unsigned int p = 0; p < PHASES; p++) {
+            if (calls[p] == 0) continue;
+            snprintf(line, sizeof line, "  %-24s %10llu calls %12.3f ms\n", PHASE_NAMES[p],
+                     (unsigned long long) calls[p], (double) nanoseconds[p] / 1e6);
+            text += line;
+        }
+        return text;
+    }
+
+    /**
+     * @return The report as a single-line JSON object: {"counters": {name: count...}, "phases": {name: {"calls": n,
+     * "ms": time}...}}, with only the phases that ran
+     */
+    std::string Report::toJson() const {
+        std::string json = "{\"counters\":{";
+        char field[128];
+        for (unsigned int c = 0; c < COUNTERS; c++) {
+            snprintf(field, sizeof field, "%s\"%s\":%llu", c ? "," : "", COUNTER_NAMES[c],
+                     (unsigned long long) counters[c]);
+            json += field;
+        }
+        json += "},\"phases\":{";
+        bool first = true;
+        for (unsigned int p = 0; p < PHASES; p++) {
+            if (calls[p] == 0) continue;
+            snprintf(field, sizeof field, "%s\"%s\":{\"calls\":%llu,\"ms\":%.3f}", first ? "" : ",", PHASE_NAMES[p],
+                     (unsigned long long) calls[p], (double) nanoseconds[p] / 1e6);
+            json += field;
+            first = false;
+        }
+        return json + "}}";
+    }
+}
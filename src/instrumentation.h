@@ -0,0 +1,118 @@
+#ifndef TRAVELLINGSALESMAN_INSTRUMENTATION_H
+#define TRAVELLINGSALESMAN_INSTRUMENTATION_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * Counters of hot-path operations and timers of solve phases, to tell where a slow run spends its time
+ * Each thread updates its own counters, without locking or shared cache lines, and they are summed when a report is
+ * collected, including those of threads that already ended
+ * Only built in when configured with -DTSP_INSTRUMENTATION=ON: otherwise count() and Scope are empty and compile away
+ */
+namespace instrumentation {
+#ifdef TSP_INSTRUMENTATION
+    constexpr bool ENABLED = true;
+#else
+    constexpr bool ENABLED = false;
+#endif
+
+    enum class Counter : unsigned int {
+        SEARCH_NODES,          // calls of tspRecursion
+        SEARCH_PRUNED,         // branches of tspRecursion cut by the bound
+        DISTANCE_LOOKUPS,      // calls of findEdge
+        HAVERSINE_FALLBACKS,   // findEdge calls without a stored edge
+        HEAP_INSERTS,          // in IndexedHeap and primSparse's queue
+        HEAP_DECREASES,
+        HEAP_EXTRACTIONS,
+        INSERTION_EVALUATIONS, // edges tried by getInsertionEdges
+        COUNT
+    };
+
+    enum class Phase : unsigned int {
+        PARSING, MATRIX_FILL, METRIC_CLOSURE, MST, TRAVERSAL, BACKTRACKING, INSERTION, ANNEALING, GENETIC, ANT_COLONY,
+        CLUSTERING, COUNT
+    };
+
+    constexpr unsigned int COUNTERS = (unsigned int) Counter::COUNT;
+    constexpr unsigned int PHASES = (unsigned int) Phase::COUNT;
+
+    /**
+     * Values of one thread; only that thread writes them, so updates are plain loads and stores, and the atomics only
+     * let the report read them while the thread runs
+     */
+    struct ThreadValues {
+        std::atomic<uint64_t> counters[COUNTERS]{};
+        std::atomic<uint64_t> nanoseconds[PHASES]{};
+        std::atomic<uint64_t> calls[PHASES]{};
+        bool registered = false;
+    };
+
+    /**
+     * Totals over every thread
+     */
+    struct Report {
+        uint64_t counters[COUNTERS]{};
+        uint64_t nanoseconds[PHASES]{};
+        uint64_t calls[PHASES]{};
+
+        [[nodiscard]] std::string toText() const;
+
+        [[nodiscard]] std::string toJson() const;
+    };
+
+    inline thread_local ThreadValues local;
+
+    void registerThread();
+
+    Report collect();
+
+    void reset();
+
+    inline void add(std::atomic<uint64_t> &value, uint64_t amount) {
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    /**
+     * Adds to a counter of the calling thread
+     * @param counter - Operation counted
+     * @param amount - Number of operations
+     */
+    inline void count(Counter counter, uint64_t amount = 1) {
+        if constexpr (ENABLED) {
+            if (!local.registered) registerThread();
+            add(local.counters[(unsigned int) counter], amount);
+        }
+    }
+
+    /**
+     * Times a phase from its construction to the end of its scope; nested phases are counted in both
+     */
+    class Scope {
+#ifdef TSP_INSTRUMENTATION
+        Phase phase;
+        std::chrono::steady_clock::time_point start;
+
+      public:
+        explicit Scope(Phase phase) : phase(phase), start(std::chrono::steady_clock::now()) {}
+
+        ~Scope() {
+            if (!local.registered) registerThread();
+            std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+            add(local.nanoseconds[(unsigned int) phase], elapsed.count());
+            add(local.calls[(unsigned int) phase], 1);
+        }
+#else
+      public:
+        explicit Scope(Phase) {}
+#endif
+
+        Scope(const Scope &) = delete;
+
+        Scope &operator=(const Scope &) = delete;
+    };
+}
+
+#endif //TRAVELLINGSALESMAN_INSTRUMENTATION_H
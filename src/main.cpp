@@ -1,8 +1,12 @@
-
 #include "menu.h"
+#include "commandLine.h"
 
-int main() {
+int main(int argc, char **argv) {
+    if (argc > 1) { //Scripted run, without the menu
+        CommandLine commandLine;
+        return commandLine.run(argc, argv);
+    }
     Menu menu;
     menu.mainMenu();
     return 0;
-}
\ No newline at end of file
+}
@@ -5,22 +5,30 @@ using namespace std;
 unsigned const Menu::COLUMN_WIDTH = 50;
 unsigned const Menu::COLUMNS_PER_LINE = 3;
 
-Menu::Menu() = default;
+Menu::Menu() {
+    graph.setThreadCount(0);
+}
 
 
 /**
- * Delegates extracting file info, calling the appropriate functions for each file
- * Time Complexity: O(n*v), where n is the number of lines of edgesFilename and v is the number of lines in nodesFilename
+ * Delegates extracting file info, calling the appropriate functions for each file, then, if turned on in the main
+ * menu, replaces missing edges by shortest paths when the graph isn't complete (see Graph::buildMetricClosure), and
+ * builds the candidate lists of the local searches
+ * Time Complexity: O(n*v), where n is the number of lines of edgesFilename and v is the number of lines in nodesFilename,
+ * plus the metric closure
  */
 void Menu::extractFileInfo(const std::string &edgesFilename, const std::string &nodesFilename) {
-    if (edgesFilename.contains("tourism")) {
-        extractEdgesFile(edgesFilename, true, true);
-    } else if (edgesFilename.contains("Extra_Fully_Connected_Graphs")) {
-        extractEdgesFile(edgesFilename, false);
-    } else extractEdgesFile(edgesFilename);
+    instrumentation::reset(); //Every run loads its graph first, so the report covers a single run
+    extractEdgesFile(edgesFilename);
     if (!nodesFilename.empty()) {
         extractNodesFile(nodesFilename);
     }
+    //Missing edges would otherwise be estimated by the haversine distance, or not at all without coordinates
+    if (metricClosure && !graph.isComplete()) {
+        cout << "Completing the graph with shortest paths..." << endl;
+        graph.buildMetricClosure();
+    }
+    graph.buildCandidateLists(Graph::CANDIDATE_LIST_SIZE); //Shared by the local searches of every run on the graph
 }
 
 /**
@@ -76,7 +84,13 @@ void Menu::mainMenu() {
             cout << setw(COLUMN_WIDTH) << setfill(' ') << "Backtracking Algorithm: [1]" << setw(COLUMN_WIDTH)
                  << "Triangular Approximation Algorithm: [2]" << setw(COLUMN_WIDTH)
                  << "Nearest Insertion Heuristic: [3]" << endl;
-            cout << setw(COLUMN_WIDTH) << "Quit: [q]" << endl;
+            cout << setw(COLUMN_WIDTH) << "Best Within a Time Limit: [4]" << setw(COLUMN_WIDTH)
+                 << "Geographic Clustering: [5]" << setw(COLUMN_WIDTH) << "Batch of Instances: [6]" << endl;
+            cout << setw(COLUMN_WIDTH) << (showBound ? "Lower Bound After Runs (on): [l]"
+                                                     : "Lower Bound After Runs (off): [l]")
+                 << setw(COLUMN_WIDTH) << (metricClosure ? "Complete Missing Edges (on): [c]"
+                                                         : "Complete Missing Edges (off): [c]")
+                 << setw(COLUMN_WIDTH) << "Quit: [q]" << endl;
         }
         cout << endl << "Press the appropriate key to the function you'd like to access: ";
         cin >> commandIn;
@@ -97,6 +111,30 @@ void Menu::mainMenu() {
                 commandIn = heuristicMenu();
                 break;
             }
+            case '4': {
+                commandIn = portfolioMenu();
+                break;
+            }
+            case '5': {
+                commandIn = clusteringMenu();
+                break;
+            }
+            case '6': {
+                commandIn = batchMenu();
+                break;
+            }
+            case 'l': {
+                //Off by default: on large graphs the bound takes far longer than the heuristics it measures
+                showBound = !showBound;
+                commandIn = '\0';
+                break;
+            }
+            case 'c': {
+                //Off by default: the closure changes the tours of incomplete graphs and makes loading them slower
+                metricClosure = !metricClosure;
+                commandIn = '\0';
+                break;
+            }
             case 'q': {
                 cout << "Thank you for using our Routing for Ocean Shipping and Urban Deliveries System!";
                 break;
@@ -110,104 +148,28 @@ void Menu::mainMenu() {
 }
 
 /**
- * Extracts and stores the information of an edges file
- * Time Complexity: 0(n) (average case) | O(n²) (worst case), where n is the number of lines of the file
+ * Extracts and stores the information of an edges file (see GraphLoader::loadEdges)
+ * Time Complexity: 0(n), where n is the number of lines of the file
  */
-void Menu::extractEdgesFile(const std::string &filename, bool hasDescriptors, bool hasLabels) {
-
-    ifstream edges(filename);
-
-    string currentParam, currentLine;
-    string originName, destinationName;
-    unsigned int originId, destinationId;
-    double distance;
-
-    int counter = 0;
-
-    vector<vector<double>> distances;
-
-    if (hasDescriptors) getline(edges, currentParam); //Ignore first line with just descriptors
-
-    while (getline(edges, currentLine, '\n')) {
-        currentLine.erase(currentLine.end() - 1); //Remove \r
-        istringstream iss(currentLine);
-        while (getline(iss, currentParam, ',')) {
-            switch (counter++) {
-                case 0: {
-                    originId = stoul(currentParam);
-                    break;
-                }
-                case 1: {
-                    destinationId = stoul(currentParam);
-                    break;
-                }
-                case 2: {
-                    distance = stod(currentParam);
-                    if (!hasLabels) counter = 0;
-                    break;
-                }
-                case 4: {
-                    counter = 0;
-                    break;
-                }
-            }
-            if (counter == 0) {
-                graph.addVertex(originId);
-                graph.addVertex(destinationId);
-                graph.addBidirectionalEdge(originId, destinationId, distance);
-            }
-        }
-    }
+void Menu::extractEdgesFile(const std::string &filename) {
+    if (!GraphLoader::loadEdges(graph, filename)) cout << "Couldn't open " << filename << endl;
 }
 
 
 /**
- * Extracts and stores the information of a vertices file
- * Time Complexity: 0(n) (average case) | O(n²) (worst case), where n is the number of lines of the file
+ * Extracts and stores the information of a vertices file (see GraphLoader::loadNodes)
+ * Time Complexity: 0(n), where n is the number of lines of the file
  */
 void Menu::extractNodesFile(const std::string &filename) {
-    {
-        ifstream nodes(filename);
-
-        string currentParam, currentLine;
-        unsigned int id;
-        double longitude, latitude;
-
-        int counter = 0;
-
-        getline(nodes, currentParam); //Ignore first line with just descriptors
-
-        while (getline(nodes, currentLine)) {
-            currentLine.erase(currentLine.end() - 1); //Remove \r
-            istringstream iss(currentLine);
-            while (getline(iss, currentParam, ',')) {
-                switch (counter++) {
-                    case 0: {
-                        id = stoul(currentParam);
-                        break;
-                    }
-                    case 1: {
-                        longitude = stod(currentParam);
-                        break;
-                    }
-                    case 2: {
-                        latitude = stod(currentParam);
-                        counter = 0;
-                        break;
-                    }
-                }
-                if (counter == 0) {
-                    auto vertex = graph.findVertex(id);
-                    vertex->setCoordinates({latitude, longitude});
-                    dataRepository.addVertexEntry(id, latitude, longitude);
-                }
-            }
-        }
-    }
+    bool opened = GraphLoader::loadNodes(graph, filename, [this](unsigned int id, double latitude, double longitude) {
+        dataRepository.addVertexEntry(id, latitude, longitude);
+    });
+    if (!opened) cout << "Couldn't open " << filename << endl;
 }
 
 /**
- * Prints the time past during the algorithm's execution
+ * Prints the time past during the algorithm's execution, and the instrumentation report of the run in builds that have
+ * it
  * @param time - Time generated in milliseconds
  */
 void Menu::printTime(double time) {
@@ -216,6 +178,25 @@ void Menu::printTime(double time) {
         std::cout << "Algorithm execution time: " << seconds << " seconds" << std::endl;
     }
     else std::cout << "Algorithm execution time: " << time << " milliseconds" << std::endl;
+    if constexpr (instrumentation::ENABLED) std::cout << instrumentation::collect().toText();
+}
+
+/**
+ * Prints the Held-Karp lower bound of the loaded graph and how far a tour is from it, if it was turned on in the main
+ * menu
+ * @param tour - Tour found by the algorithm (nothing is printed if it is empty)
+ */
+void Menu::printBound(const Tour &tour) {
+    if (!showBound || tour.empty()) return;
+    Graph::lower_bound_t lowerBound = graph.heldKarpBound(Graph::HELD_KARP_ITERATIONS, tour.getLength());
+    if (lowerBound.bound == constants::INF) {
+        cout << "LOWER BOUND: no tour visits every stop" << endl;
+        return;
+    }
+    cout << "LOWER BOUND: " << fixed << setprecision(2) << lowerBound.bound << endl;
+    if (lowerBound.bound > 0)
+        cout << "GAP: " << fixed << setprecision(2)
+             << std::max(0.0, (tour.getLength() - lowerBound.bound) / lowerBound.bound * 100) << "%" << endl;
 }
 
 /**
@@ -276,17 +257,17 @@ unsigned int Menu::backtrackingMenu() {
 
             std::chrono::time_point<std::chrono::high_resolution_clock> startTime = std::chrono::high_resolution_clock::now();
 
-            auto result = graph.tspBT();
+            Tour result = graph.tspBT();
 
             std::chrono::time_point<std::chrono::high_resolution_clock> endTime = std::chrono::high_resolution_clock::now();
             std::chrono::duration<double, std::milli> duration = endTime - startTime;
             double milliseconds = duration.count();
             printTime(milliseconds);
 
-            cout << "TOUR LENGTH: " << fixed << setprecision(2) << result.first << endl;
+            cout << "TOUR LENGTH: " << fixed << setprecision(2) << result.getLength() << endl;
 
             if (graph.getNumVertex() <= 25) {
-                graph.printTour(result.second);
+                graph.printTour(result);
             }
         }
     }
@@ -431,17 +412,191 @@ unsigned int Menu::triangularApproximationMenu() {
 
             std::chrono::time_point<std::chrono::high_resolution_clock> startTime = std::chrono::high_resolution_clock::now();
 
-            graph.triangularTSPTour();
+            Tour result = graph.triangularTSPTour();
+
+            std::chrono::time_point<std::chrono::high_resolution_clock> endTime = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double, std::milli> duration = endTime - startTime;
+            double milliseconds = duration.count();
+            printTime(milliseconds);
+
+            if (result.empty()) {
+                cout << endl << "Couldn't calculate approximation of TSP for this graph!" << endl;
+                continue;
+            }
+            cout << endl << "TOUR LENGTH: " << fixed << setprecision(2) << result.getLength() << endl;
+            printBound(result);
+
+            if (graph.getNumVertex() <= 25) {
+                graph.printTour(result);
+            }
+        }
+    }
+    return commandIn;
+}
+
+
+/**
+ * Outputs the time-limited portfolio menu screen and decides graph function calls according to user input
+ * @return - Last inputted command, or '\0' for previous menu command
+ */
+unsigned int Menu::portfolioMenu() {
+    unsigned char commandIn = '\0';
+
+    while (commandIn != 'q') {
+        //Header
+        cout << setw(COLUMN_WIDTH * COLUMNS_PER_LINE / 2) << setfill('-') << right << "BEST WITHIN A TI";
+        cout << setw(COLUMN_WIDTH * COLUMNS_PER_LINE / 2) << left << "ME LIMIT" << endl;
+
+        cout << setw(COLUMN_WIDTH) << setfill(' ') << "Stadiums: [1]" << setw(COLUMN_WIDTH) << "Tourism: [2]" << endl;
+
+        cout << setw(COLUMN_WIDTH) << setfill(' ') << "Connected Graph 25: [3]" << setw(COLUMN_WIDTH)
+             << "Connected Graph 50: [4]" << setw(COLUMN_WIDTH)
+             << "Connected Graph 75: [5]" << endl;
+        cout << setw(COLUMN_WIDTH) << setfill(' ') << "Connected Graph 100: [6]" << setw(COLUMN_WIDTH)
+             << "Connected Graph 200: [7]" << setw(COLUMN_WIDTH)
+             << "Connected Graph 300: [8]" << endl;
+        cout << setw(COLUMN_WIDTH) << setfill(' ') << "Connected Graph 400: [9]" << setw(COLUMN_WIDTH) << setfill(' ')
+             << "Connected Graph 500: [A]" << setw(COLUMN_WIDTH)
+             << "Connected Graph 600: [C]" << endl;
+        cout << setw(COLUMN_WIDTH) << setfill(' ') << "Connected Graph 700: [D]" << setw(COLUMN_WIDTH) << setfill(' ')
+             << "Connected Graph 800: [E]" << setw(COLUMN_WIDTH)
+             << "Connected Graph 900: [F]" << endl;
+        cout << setw(COLUMN_WIDTH) << setfill(' ') << "Real World Graph 1: [G]" << setw(COLUMN_WIDTH) << setfill(' ')
+             << "Real World Graph 2: [H]" << setw(COLUMN_WIDTH)
+             << "Real World Graph 3: [I]" << endl;
+        cout << setw(COLUMN_WIDTH) << "Back: [b]" << setw(COLUMN_WIDTH) << "Quit: [q]" << endl;
+
+        cout << endl
+             << "Please select the problem for which you'd like to find the best tour within a time limit: ";
+        cin >> commandIn;
+
+        if (commandIn != 'q' && commandIn != 'b') commandIn = toupper(commandIn);
+        std::string nodesFilePath, edgesFilePath;
+
+        if (!checkInput(1)) {
+            commandIn = '\0';
+            continue;
+        }
+        switch (commandIn) {
+            case '1': {
+                edgesFilePath = "../dataset/Toy-Graphs/stadiums.csv";
+                break;
+            }
+            case '2': {
+                edgesFilePath = "../dataset/Toy-Graphs/tourism.csv";
+                break;
+            }
+            case '3': {
+                edgesFilePath = "../dataset/Extra_Fully_Connected_Graphs/edges_25.csv";
+                break;
+            }
+            case '4': {
+                edgesFilePath = "../dataset/Extra_Fully_Connected_Graphs/edges_50.csv";
+                break;
+            }
+            case '5': {
+                edgesFilePath = "../dataset/Extra_Fully_Connected_Graphs/edges_75.csv";
+                break;
+            }
+            case '6': {
+                edgesFilePath = "../dataset/Extra_Fully_Connected_Graphs/edges_100.csv";
+                break;
+            }
+            case '7': {
+                edgesFilePath = "../dataset/Extra_Fully_Connected_Graphs/edges_200.csv";
+                break;
+            }
+            case '8': {
+                edgesFilePath = "../dataset/Extra_Fully_Connected_Graphs/edges_300.csv";
+                break;
+            }
+            case '9': {
+                edgesFilePath = "../dataset/Extra_Fully_Connected_Graphs/edges_400.csv";
+                break;
+            }
+            case 'A': {
+                edgesFilePath = "../dataset/Extra_Fully_Connected_Graphs/edges_500.csv";
+                break;
+            }
+            case 'C': {
+                edgesFilePath = "../dataset/Extra_Fully_Connected_Graphs/edges_600.csv";
+                break;
+            }
+            case 'D': {
+                edgesFilePath = "../dataset/Extra_Fully_Connected_Graphs/edges_700.csv";
+                break;
+            }
+            case 'E': {
+                edgesFilePath = "../dataset/Extra_Fully_Connected_Graphs/edges_800.csv";
+                break;
+            }
+            case 'F': {
+                edgesFilePath = "../dataset/Extra_Fully_Connected_Graphs/edges_900.csv";
+                break;
+            }
+            case 'G': {
+                edgesFilePath = "../dataset/Real-world-Graphs/graph1/edges.csv";
+                nodesFilePath = "../dataset/Real-world-Graphs/graph1/nodes.csv";
+                break;
+            }
+            case 'H': {
+                edgesFilePath = "../dataset/Real-world-Graphs/graph2/edges.csv";
+                nodesFilePath = "../dataset/Real-world-Graphs/graph2/nodes.csv";
+                break;
+            }
+            case 'I': {
+                edgesFilePath = "../dataset/Real-world-Graphs/graph3/edges.csv";
+                nodesFilePath = "../dataset/Real-world-Graphs/graph3/nodes.csv";
+                break;
+            }
+            case 'b': {
+                return '\0';
+            }
+            case 'q': {
+                cout << "Thank you for using our Routing for Ocean Shipping and Urban Deliveries System!" << endl;
+                break;
+            }
+            default:
+                cout << "Please press one of listed keys." << endl;
+                break;
+        }
+
+        if (!edgesFilePath.empty()) {
+            unsigned int budget;
+            cout << "Time limit, in milliseconds: ";
+            cin >> budget;
+            if (!checkInput()) continue;
+
+            cout << endl << "Loading graph..." << endl;
+            graph.clearGraph();
+            dataRepository.clearData();
+            extractFileInfo(edgesFilePath, nodesFilePath);
+
+            cout << "Calculating..." << endl;
+
+            std::chrono::time_point<std::chrono::high_resolution_clock> startTime = std::chrono::high_resolution_clock::now();
+
+            //Every improvement is shown as soon as it is found
+            SolverHandle solver(graph, SolverHandle::Engine::PORTFOLIO, {std::chrono::milliseconds(budget)},
+                                [](const Improvement &improvement) {
+                                    cout << "  " << fixed << setprecision(2) << improvement.tour.getLength()
+                                         << " after " << improvement.milliseconds << " ms ("
+                                         << improvement.engine << ")" << endl;
+                                });
+            Improvement result = solver.wait();
 
             std::chrono::time_point<std::chrono::high_resolution_clock> endTime = std::chrono::high_resolution_clock::now();
             std::chrono::duration<double, std::milli> duration = endTime - startTime;
             double milliseconds = duration.count();
             printTime(milliseconds);
 
-            cout << endl << "TOUR LENGTH: " << fixed << setprecision(2) << graph.getTourDistance() << endl;
+            cout << endl << "TOUR LENGTH: " << fixed << setprecision(2) << result.tour.getLength()
+                 << (solver.isOptimal() ? " (optimal)" : "") << endl;
+            cout << "FOUND BY: " << (result.engine.empty() ? "no engine" : result.engine) << endl;
+            printBound(result.tour);
 
             if (graph.getNumVertex() <= 25) {
-                graph.printTour();
+                graph.printTour(result.tour);
             }
         }
     }
@@ -564,27 +719,149 @@ unsigned int Menu::heuristicMenu() {
             extractFileInfo(edgesFilePath, nodesFilePath);
 
             auto start = random<unsigned int>(0, graph.getNumVertex() - 1);
-            if (edgesFilePath.contains("Real-world-Graphs"))
-                start = dataRepository.getFurthestVertex().getId();
+            std::optional<unsigned int> furthest = dataRepository.getFurthestVertex();
+            if (edgesFilePath.contains("Real-world-Graphs") && furthest)
+                start = graph.findVertexByExternalId(*furthest).value_or(start);
 
             cout << "Calculating..." << endl;
 
             std::chrono::time_point<std::chrono::high_resolution_clock> startTime = std::chrono::high_resolution_clock::now();
 
-            auto result = graph.nearestInsertionHeuristic(start);
+            Tour result = graph.nearestInsertionHeuristic(start);
 
             std::chrono::time_point<std::chrono::high_resolution_clock> endTime = std::chrono::high_resolution_clock::now();
             std::chrono::duration<double, std::milli> duration = endTime - startTime;
             double milliseconds = duration.count();
             printTime(milliseconds);
 
-            cout << "TOUR LENGTH: " << fixed << setprecision(2) << result.first << endl;
+            cout << "TOUR LENGTH: " << fixed << setprecision(2) << result.getLength() << endl;
+            printBound(result);
 
             if (graph.getNumVertex() <= 25) {
-                graph.printTour(result.second);
+                graph.printTour(result);
             }
         }
     }
     return commandIn;
 }
 
+
+/**
+ * Outputs geographic clustering menu screen and decides graph function calls according to user input
+ * Only the real-world graphs have the coordinates the clusters are made from
+ * @return - Last inputted command, or '\0' for previous menu command
+ */
+unsigned int Menu::clusteringMenu() {
+    unsigned char commandIn = '\0';
+
+    while (commandIn != 'q') {
+        //Header
+        cout << setw(COLUMN_WIDTH * COLUMNS_PER_LINE / 2) << setfill('-') << right << "GEOGRAPHIC CL";
+        cout << setw(COLUMN_WIDTH * COLUMNS_PER_LINE / 2) << left << "USTERING" << endl;
+        cout << setw(COLUMN_WIDTH) << setfill(' ') << "Real World Graph 1: [1]" << setw(COLUMN_WIDTH)
+             << "Real World Graph 2: [2]" << setw(COLUMN_WIDTH) << "Real World Graph 3: [3]" << endl;
+        cout << setw(COLUMN_WIDTH) << "Back: [b]" << setw(COLUMN_WIDTH) << "Quit: [q]" << endl;
+
+        cout << endl << "Please select the problem for which you'd like to execute the clustering algorithm: ";
+        cin >> commandIn;
+
+        std::string nodesFilePath, edgesFilePath;
+
+        if (!checkInput(1)) {
+            commandIn = '\0';
+            continue;
+        }
+        switch (commandIn) {
+            case '1': {
+                edgesFilePath = "../dataset/Real-world-Graphs/graph1/edges.csv";
+                nodesFilePath = "../dataset/Real-world-Graphs/graph1/nodes.csv";
+                break;
+            }
+            case '2': {
+                edgesFilePath = "../dataset/Real-world-Graphs/graph2/edges.csv";
+                nodesFilePath = "../dataset/Real-world-Graphs/graph2/nodes.csv";
+                break;
+            }
+            case '3': {
+                edgesFilePath = "../dataset/Real-world-Graphs/graph3/edges.csv";
+                nodesFilePath = "../dataset/Real-world-Graphs/graph3/nodes.csv";
+                break;
+            }
+            case 'b': {
+                return '\0';
+            }
+            case 'q': {
+                cout << "Thank you for using our Routing for Ocean Shipping and Urban Deliveries System!" << endl;
+                break;
+            }
+            default:
+                cout << "Please press one of listed keys." << endl;
+                break;
+        }
+
+        if (!edgesFilePath.empty()) {
+            cout << endl << "Loading graph..." << endl;
+            graph.clearGraph();
+            dataRepository.clearData();
+            extractFileInfo(edgesFilePath, nodesFilePath);
+
+            cout << "Calculating..." << endl;
+
+            std::chrono::time_point<std::chrono::high_resolution_clock> startTime = std::chrono::high_resolution_clock::now();
+
+            Tour result = graph.clusteredTSPTour();
+
+            std::chrono::time_point<std::chrono::high_resolution_clock> endTime = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double, std::milli> duration = endTime - startTime;
+            double milliseconds = duration.count();
+            printTime(milliseconds);
+
+            cout << endl << "TOUR LENGTH: " << fixed << setprecision(2) << result.getLength() << endl;
+            printBound(result);
+        }
+    }
+    return commandIn;
+}
+
+/**
+ * Asks for a manifest of instances and a time limit per instance, then solves every instance with the portfolio of
+ * solvers on a pool of workers, printing each result as soon as it is ready
+ * @return - '\0' for previous menu command
+ */
+unsigned int Menu::batchMenu() {
+    string manifestPath;
+    unsigned int budget;
+    cout << setw(COLUMN_WIDTH * COLUMNS_PER_LINE / 2) << setfill('-') << right << "BATCH OF I";
+    cout << setw(COLUMN_WIDTH * COLUMNS_PER_LINE / 2) << left << "NSTANCES" << setfill(' ') << endl;
+    cout << "Manifest (one \"edges file[,nodes file]\" per line): ";
+    cin >> manifestPath;
+    cout << "Time limit per instance, in milliseconds: ";
+    cin >> budget;
+    if (!checkInput()) return '\0';
+
+    std::vector<BatchSolver::Instance> instances;
+    if (!BatchSolver::readManifest(manifestPath, instances)) {
+        cout << "Couldn't open " << manifestPath << endl;
+        return '\0';
+    }
+    cout << endl << "Solving " << instances.size() << " instances..." << endl;
+    instrumentation::reset();
+
+    BatchSolver::Options options;
+    options.engine = SolverHandle::Engine::PORTFOLIO;
+    options.budget.time = std::chrono::milliseconds(budget);
+    options.metricClosure = metricClosure;
+    BatchSolver batch(options, [](const BatchSolver::Result &result) {
+        cout << "  [" << result.index + 1 << "] " << result.instance.edgesFile << ": ";
+        if (!result.loaded) cout << "couldn't be loaded" << endl;
+        else
+            cout << fixed << setprecision(2) << result.length << (result.optimal ? " (optimal)" : "") << ", "
+                 << result.stops << " stops, " << result.loadMilliseconds + result.solveMilliseconds << " ms" << endl;
+    });
+    BatchSolver::Summary summary = batch.run(instances);
+
+    cout << endl << "SOLVED: " << summary.solved << " (" << summary.failed << " couldn't be loaded)" << endl;
+    printTime(summary.seconds * 1000);
+    cout << "THROUGHPUT: " << fixed << setprecision(2) << summary.instancesPerSecond << " instances per second" << endl;
+    return '\0';
+}
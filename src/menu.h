@@ -12,21 +12,26 @@
 #include <unordered_set>
 #include <chrono>
 #include "graph.h"
+#include "solverHandle.h"
+#include "batchSolver.h"
 #include "dataRepository.h"
+#include "graphLoader.h"
+#include "xoshiro.h"
+#include "instrumentation.h"
 
 class Menu {
   private:
     DataRepository dataRepository;
     Graph graph;
+    bool showBound = false; // whether runs are followed by the Held-Karp lower bound
+    bool metricClosure = false; // whether incomplete graphs are completed with shortest paths when loaded
     unsigned static const COLUMN_WIDTH;
     unsigned static const COLUMNS_PER_LINE;
 
     template<typename T>
     T random(T range_from, T range_to) {
-        std::random_device rand_dev;
-        std::mt19937 generator(rand_dev());
         std::uniform_int_distribution<T> distr(range_from, range_to);
-        return distr(generator);
+        return distr(Xoshiro256::local());
     }
 
   public:
@@ -34,7 +39,7 @@ class Menu {
 
     void extractNodesFile(const std::string &filename);
 
-    void extractEdgesFile(const std::string &filename, bool hasDescriptors = true, bool hasLabels = false);
+    void extractEdgesFile(const std::string &filename);
 
     void extractFileInfo(const std::string &edgesFilename, const std::string &nodesFilename = "");
 
@@ -48,7 +53,15 @@ class Menu {
 
     unsigned int heuristicMenu();
 
+    unsigned int portfolioMenu();
+
+    unsigned int clusteringMenu();
+
+    unsigned int batchMenu();
+
     void printTime(double time);
+
+    void printBound(const Tour &tour);
 };
 
 
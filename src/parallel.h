@@ -0,0 +1,43 @@
+#ifndef TRAVELLINGSALESMAN_PARALLEL_H
+#define TRAVELLINGSALESMAN_PARALLEL_H
+
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+namespace parallel {
+    /**
+     * @param requested - Number of threads asked for (0 for one per hardware thread)
+     * @return Number of threads to use
+     */
+    inline unsigned int threadCount(unsigned int requested = 0) {
+        if (requested != 0) return requested;
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    /**
+     * Splits [0, count) into one contiguous block per thread and calls f(first, last, thread) on each block
+     * The calling thread takes the first block, and the call returns once every block is done
+     * @param count - Number of items
+     * @param threads - Number of threads to use (0 for one per hardware thread)
+     * @param f - Function called with the bounds of each block and the index of the thread running it
+     */
+    template<typename F>
+    void forBlocks(unsigned int count, unsigned int threads, F f) {
+        threads = std::min(threadCount(threads), std::max(count, 1u));
+        if (threads == 1) {
+            f(0u, count, 0u);
+            return;
+        }
+        std::vector<std::jthread> workers;
+        workers.reserve(threads - 1);
+        unsigned int block = (count + threads - 1) / threads;
+        for (unsigned int t = 1; t < threads; t++) {
+            unsigned int first = std::min(count, t * block), last = std::min(count, first + block);
+            workers.emplace_back([=, &f] { f(first, last, t); });
+        }
+        f(0u, std::min(count, block), 0u);
+    }
+}
+
+#endif //TRAVELLINGSALESMAN_PARALLEL_H
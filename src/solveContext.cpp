@@ -0,0 +1,51 @@
+#include "solveContext.h"
+#include "constants.h"
+
+/**
+ * Resets the per-vertex state for a run on a graph with n vertices: nothing visited, infinite distances, no parents
+ * Time Complexity: O(n)
+ * @param n - Number of vertices
+ */
+void SolveContext::prepare(unsigned int n) {
+    visited.assign(n, false);
+    dist.assign(n, constants::INF);
+    parent.assign(n, constants::NO_VERTEX);
+}
+
+SolveContextPool::Lease::Lease(SolveContextPool *pool, std::unique_ptr<SolveContext> context)
+        : pool(pool), context(std::move(context)) {}
+
+SolveContextPool::Lease::~Lease() {
+    if (context != nullptr) pool->release(std::move(context));
+}
+
+/**
+ * Borrows an idle context, or a new one if every context is in use
+ * Time Complexity: O(1)
+ * @return Lease of the context, which returns it to the pool when destroyed
+ */
+SolveContextPool::Lease SolveContextPool::acquire() {
+    std::unique_ptr<SolveContext> context;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!idle.empty()) {
+            context = std::move(idle.back());
+            idle.pop_back();
+        }
+    }
+    if (context == nullptr) context = std::make_unique<SolveContext>();
+    return {this, std::move(context)};
+}
+
+void SolveContextPool::release(std::unique_ptr<SolveContext> context) {
+    std::lock_guard<std::mutex> lock(mutex);
+    idle.push_back(std::move(context));
+}
+
+/**
+ * Frees the idle contexts (contexts currently leased still return to the pool)
+ */
+void SolveContextPool::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    idle.clear();
+}
@@ -0,0 +1,77 @@
+#ifndef TRAVELLINGSALESMAN_SOLVECONTEXT_H
+#define TRAVELLINGSALESMAN_SOLVECONTEXT_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <array>
+#include "indexedHeap.h"
+
+/**
+ * Scratch state of a single solver run: per-vertex marks, distances and tree parents, plus the work arrays the
+ * algorithms reuse between runs
+ * The Graph itself stays read-only while solving, so runs that each use their own context can share one Graph
+ */
+class SolveContext {
+  public:
+    std::vector<bool> visited;
+    std::vector<double> dist;
+    std::vector<unsigned int> parent; // constants::NO_VERTEX if none
+    std::vector<double> key; // Prim keys
+    IndexedHeap<4> heap; // Prim keys of the vertices reached but not yet in the tree
+    // children of each vertex of a tree in CSR form: the children of v are at [childOffsets[v], childOffsets[v + 1])
+    std::vector<unsigned int> childOffsets;
+    std::vector<unsigned int> children;
+    std::vector<unsigned int> stack;
+    std::vector<int> degree; // degree of each vertex in a 1-tree
+    std::vector<std::array<double, 3>> points; // coordinates of each vertex as a unit vector
+    std::vector<unsigned int> path;     // partial solution being explored
+    std::vector<unsigned int> bestPath; // best solution found so far
+    unsigned int steps = 0; // search steps taken, used to check deadlines only every so often
+
+    void prepare(unsigned int n);
+};
+
+/**
+ * Thread-safe pool of SolveContexts, so repeated and concurrent runs reuse already allocated buffers
+ * A context is borrowed through a Lease, which hands it back to the pool when destroyed
+ */
+class SolveContextPool {
+  private:
+    std::mutex mutex;
+    std::vector<std::unique_ptr<SolveContext>> idle;
+
+    void release(std::unique_ptr<SolveContext> context);
+
+  public:
+    class Lease {
+      private:
+        SolveContextPool *pool;
+        std::unique_ptr<SolveContext> context;
+
+      public:
+        Lease(SolveContextPool *pool, std::unique_ptr<SolveContext> context);
+
+        Lease(Lease &&other) noexcept = default;
+
+        Lease &operator=(Lease &&other) = delete;
+
+        ~Lease();
+
+        SolveContext &operator*() const {
+            return *context;
+        }
+
+        SolveContext *operator->() const {
+            return context.get();
+        }
+    };
+
+    Lease acquire();
+
+    void clear();
+};
+
+
+#endif //TRAVELLINGSALESMAN_SOLVECONTEXT_H
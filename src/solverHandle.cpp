@@ -0,0 +1,117 @@
+#include "solverHandle.h"
+
+/**
+ * Starts solving in a background thread
+ * @param graph - Loaded graph to solve
+ * @param engine - Solver to run
+ * @param budget - Time and iterations allowed (backtracking charges its search steps 4096 at a time, simulated
+ * annealing its proposed moves 1024 at a time, the genetic algorithm and the ant colony their generations and
+ * iterations one by one)
+ * @param onImprovement - Function called with every new best tour, from the solving thread
+ * @param token - External cancellation token: requesting a stop on its source cancels the solve
+ */
+SolverHandle::SolverHandle(const Graph &graph, Engine engine, Budget budget, Incumbent::Callback onImprovement,
+                           const std::stop_token &token)
+        : graph(graph), engine(engine),
+          incumbent(budget.time == std::chrono::milliseconds::max()
+                    ? std::chrono::steady_clock::time_point::max()
+                    : std::chrono::steady_clock::now() + budget.time,
+                    budget.iterations, std::move(onImprovement)) {
+    if (token.stop_possible()) onStopRequested.emplace(token, [this] { incumbent.stop(); });
+    worker = std::jthread([this] { run(); });
+}
+
+/**
+ * Cancels the solve, if it is still running, and waits for it to stop
+ */
+SolverHandle::~SolverHandle() {
+    cancel();
+}
+
+void SolverHandle::run() {
+    solve(graph, engine, incumbent);
+    done.store(true, std::memory_order_release);
+}
+
+/**
+ * Runs an engine on the calling thread until it finishes or the incumbent expires
+ * @param graph - Loaded graph to solve
+ * @param engine - Solver to run
+ * @param incumbent - Receives the tours found, and says when to stop
+ * @param colony - Options of the ant colony engine, with the function receiving its iteration statistics
+ */
+void SolverHandle::solve(const Graph &graph, Engine engine, Incumbent &incumbent, const Graph::colony_t &colony) {
+    switch (engine) {
+        case Engine::BACKTRACKING: {
+            SolveContext context;
+            graph.tspBT(context, &incumbent);
+            break;
+        }
+        case Engine::TRIANGULAR_APPROXIMATION: {
+            SolveContext context;
+            incumbent.offer(graph.triangularTSPTour(context), "triangular approximation");
+            incumbent.charge();
+            break;
+        }
+        case Engine::NEAREST_INSERTION: {
+            SolveContext context;
+            graph.nearestInsertionSearch(incumbent, context);
+            break;
+        }
+        case Engine::SIMULATED_ANNEALING:
+            graph.annealingSearch(incumbent, Graph::annealing_t());
+            break;
+        case Engine::GENETIC_ALGORITHM:
+            graph.geneticSearch(incumbent, Graph::genetic_t());
+            break;
+        case Engine::ANT_COLONY:
+            graph.antColonySearch(incumbent, colony);
+            break;
+        case Engine::CLUSTERING:
+            incumbent.offer(graph.clusteredTSPTour(), "clustering");
+            incumbent.charge();
+            break;
+        case Engine::PORTFOLIO:
+            graph.portfolioSearch(incumbent);
+            break;
+    }
+}
+
+/**
+ * @return Best tour so far, the engine that found it and when (an empty tour if none was found yet)
+ */
+Improvement SolverHandle::getBest() const {
+    return incumbent.getBest();
+}
+
+bool SolverHandle::isDone() const {
+    return done.load(std::memory_order_acquire);
+}
+
+/**
+ * @return true if the best tour is proven optimal (only backtracking, alone or in the portfolio, can prove it)
+ */
+bool SolverHandle::isOptimal() const {
+    return incumbent.isOptimal();
+}
+
+unsigned long SolverHandle::getIterations() const {
+    return incumbent.getIterations();
+}
+
+/**
+ * Asks the solve to stop as soon as possible, and waits for it
+ */
+void SolverHandle::cancel() {
+    incumbent.stop();
+    if (worker.joinable()) worker.join();
+}
+
+/**
+ * Waits for the solve to end, by itself or through its budget
+ * @return The best tour found
+ */
+Improvement SolverHandle::wait() {
+    if (worker.joinable()) worker.join();
+    return incumbent.getBest();
+}
@@ -0,0 +1,68 @@
+#ifndef TRAVELLINGSALESMAN_SOLVERHANDLE_H
+#define TRAVELLINGSALESMAN_SOLVERHANDLE_H
+
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include "graph.h"
+#include "incumbent.h"
+
+/**
+ * Anytime solve running in the background on a loaded Graph
+ * The best tour so far can be read at any moment, every improvement is reported to an optional callback, and the
+ * search stops when its time or iteration budget is spent, when cancelled, or when a given stop token is triggered
+ * The Graph must outlive the handle and must not be modified while it runs
+ */
+class SolverHandle {
+  public:
+    enum class Engine {
+        BACKTRACKING, TRIANGULAR_APPROXIMATION, NEAREST_INSERTION, SIMULATED_ANNEALING, GENETIC_ALGORITHM,
+        ANT_COLONY, CLUSTERING, PORTFOLIO
+    };
+
+    struct Budget {
+        std::chrono::milliseconds time = std::chrono::milliseconds::max();
+        unsigned long iterations = std::numeric_limits<unsigned long>::max(); // engine-specific units of work
+    };
+
+  private:
+    const Graph &graph;
+    Engine engine;
+    Incumbent incumbent;
+    std::atomic<bool> done = false;
+    std::optional<std::stop_callback<std::function<void()>>> onStopRequested;
+    std::jthread worker; // last, so it is joined before the rest is destroyed
+
+    void run();
+
+  public:
+    SolverHandle(const Graph &graph, Engine engine, Budget budget, Incumbent::Callback onImprovement = {},
+                 const std::stop_token &token = {});
+
+    SolverHandle(const SolverHandle &) = delete;
+
+    SolverHandle &operator=(const SolverHandle &) = delete;
+
+    static void solve(const Graph &graph, Engine engine, Incumbent &incumbent,
+                      const Graph::colony_t &colony = Graph::colony_t());
+
+    ~SolverHandle();
+
+    [[nodiscard]] Improvement getBest() const;
+
+    [[nodiscard]] bool isDone() const;
+
+    [[nodiscard]] bool isOptimal() const;
+
+    [[nodiscard]] unsigned long getIterations() const;
+
+    void cancel();
+
+    Improvement wait();
+};
+
+
+#endif //TRAVELLINGSALESMAN_SOLVERHANDLE_H
@@ -0,0 +1,144 @@
+#include "storageBuffer.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+StorageBuffer::StorageBuffer(std::string directory) : directory(std::move(directory)) {}
+
+StorageBuffer::StorageBuffer(StorageBuffer &&other) noexcept {
+    *this = std::move(other);
+}
+
+StorageBuffer &StorageBuffer::operator=(StorageBuffer &&other) noexcept {
+    if (this == &other) return *this;
+    unmap();
+    directory = std::move(other.directory);
+    heap = std::move(other.heap);
+    mapped = std::exchange(other.mapped, nullptr);
+    mappedCapacity = std::exchange(other.mappedCapacity, 0);
+    used = std::exchange(other.used, 0);
+    fd = std::exchange(other.fd, -1);
+    return *this;
+}
+
+StorageBuffer::~StorageBuffer() {
+    unmap();
+}
+
+/**
+ * Maps (or remaps) the backing file with a given capacity, creating the file on first use
+ * Time Complexity: O(1) (the file is grown sparsely)
+ * @param capacity - Number of bytes to map
+ * @return true if the mapping succeeded
+ */
+bool StorageBuffer::map(size_t capacity) {
+    if (fd == -1) {
+        std::string pattern = directory + "/tsp-distances-XXXXXX";
+        fd = mkstemp(pattern.data());
+        if (fd == -1) return false;
+        unlink(pattern.c_str()); //Removed from the directory now, deleted when the descriptor is closed
+    }
+    if (ftruncate(fd, (off_t) capacity) != 0) return false;
+
+    void *address = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) return false;
+    if (mapped != nullptr) munmap(mapped, mappedCapacity);
+    mapped = static_cast<std::byte *>(address);
+    mappedCapacity = capacity;
+    return true;
+}
+
+void StorageBuffer::unmap() {
+    if (mapped != nullptr) munmap(mapped, mappedCapacity);
+    if (fd != -1) close(fd);
+    mapped = nullptr;
+    mappedCapacity = 0;
+    fd = -1;
+}
+
+/**
+ * @return Number of bytes in use
+ */
+size_t StorageBuffer::size() const {
+    return used;
+}
+
+/**
+ * @return Number of bytes reserved, in RAM or in the backing file
+ */
+size_t StorageBuffer::capacity() const {
+    return mapped != nullptr ? mappedCapacity : heap.capacity();
+}
+
+bool StorageBuffer::isMapped() const {
+    return mapped != nullptr;
+}
+
+const std::string &StorageBuffer::getDirectory() const {
+    return directory;
+}
+
+/**
+ * Changes the number of bytes in use, keeping the current contents (new bytes are unspecified)
+ * File-backed buffers grow geometrically, in whole pages; if the file can't be mapped, the data moves to the heap
+ * Time Complexity: O(1) amortized (file-backed) | O(bytes) amortized (heap)
+ * @param bytes - New number of bytes in use
+ */
+void StorageBuffer::resize(size_t bytes) {
+    if (!directory.empty() && bytes > mappedCapacity) {
+        size_t page = (size_t) sysconf(_SC_PAGESIZE);
+        size_t capacity = std::max(bytes, mappedCapacity * 2);
+        capacity = (capacity + page - 1) / page * page;
+        if (!map(capacity)) {
+            fprintf(stderr, "Couldn't map distance storage in %s, keeping it in memory instead!\n", directory.c_str());
+            std::vector<std::byte> copy(mapped, mapped + used);
+            unmap();
+            directory.clear();
+            heap = std::move(copy);
+        }
+    }
+    if (mapped == nullptr) heap.resize(bytes);
+    used = bytes;
+}
+
+/**
+ * Tells the kernel how a byte range is about to be accessed, so it can read ahead or drop pages
+ * Does nothing for heap buffers
+ * Time Complexity: O(1)
+ * @param access - Expected access pattern
+ * @param offset - First byte of the range
+ * @param length - Number of bytes in the range (0 for the whole buffer)
+ */
+void StorageBuffer::advise(Access access, size_t offset, size_t length) const {
+    if (mapped == nullptr || offset >= used) return;
+
+    size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    size_t end = length == 0 ? used : std::min(used, offset + length);
+    size_t start = offset / page * page;
+
+    int advice = MADV_NORMAL;
+    switch (access) {
+        case Access::SEQUENTIAL:
+            advice = MADV_SEQUENTIAL;
+            break;
+        case Access::RANDOM:
+            advice = MADV_RANDOM;
+            break;
+        case Access::WILLNEED:
+            advice = MADV_WILLNEED;
+            break;
+        default:
+            break;
+    }
+    madvise(mapped + start, end - start, advice);
+}
+
+void StorageBuffer::clear() {
+    unmap();
+    heap = {};
+    used = 0;
+}
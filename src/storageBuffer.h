@@ -0,0 +1,68 @@
+#ifndef TRAVELLINGSALESMAN_STORAGEBUFFER_H
+#define TRAVELLINGSALESMAN_STORAGEBUFFER_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+/**
+ * Growable block of bytes kept either on the heap or in a memory-mapped temporary file
+ * File-backed buffers let the operating system page data in and out, so they can be larger than the available RAM
+ * The file is created in the given directory and unlinked right away, so it disappears with the buffer
+ */
+class StorageBuffer {
+  public:
+    enum class Access {
+        NORMAL, SEQUENTIAL, RANDOM, WILLNEED
+    };
+
+  private:
+    std::string directory; // where the backing file lives (empty for heap storage)
+    std::vector<std::byte> heap;
+    std::byte *mapped = nullptr;
+    size_t mappedCapacity = 0;
+    size_t used = 0;
+    int fd = -1;
+
+    bool map(size_t capacity);
+
+    void unmap();
+
+  public:
+    explicit StorageBuffer(std::string directory = "");
+
+    StorageBuffer(const StorageBuffer &) = delete;
+
+    StorageBuffer &operator=(const StorageBuffer &) = delete;
+
+    StorageBuffer(StorageBuffer &&other) noexcept;
+
+    StorageBuffer &operator=(StorageBuffer &&other) noexcept;
+
+    ~StorageBuffer();
+
+    [[nodiscard]] std::byte *data() {
+        return mapped != nullptr ? mapped : heap.data();
+    }
+
+    [[nodiscard]] const std::byte *data() const {
+        return mapped != nullptr ? mapped : heap.data();
+    }
+
+    [[nodiscard]] size_t size() const;
+
+    [[nodiscard]] size_t capacity() const;
+
+    [[nodiscard]] bool isMapped() const;
+
+    [[nodiscard]] const std::string &getDirectory() const;
+
+    void resize(size_t bytes);
+
+    void advise(Access access, size_t offset = 0, size_t length = 0) const;
+
+    void clear();
+};
+
+
+#endif //TRAVELLINGSALESMAN_STORAGEBUFFER_H
@@ -0,0 +1,195 @@
+#include "tour.h"
+#include <algorithm>
+
+/**
+ * @param vertexCount - Number of vertices the tour is expected to visit (only used to reserve memory)
+ */
+Tour::Tour(unsigned int vertexCount) {
+    reserve(vertexCount);
+}
+
+void Tour::reserve(unsigned int vertexCount) {
+    order.reserve(vertexCount);
+    if (position.size() < vertexCount) position.resize(vertexCount, NOT_IN_TOUR);
+}
+
+/**
+ * Removes every vertex, keeping the reserved memory
+ * Time Complexity: O(n)
+ */
+void Tour::clear() {
+    for (unsigned int id: order) position[id] = NOT_IN_TOUR;
+    order.clear();
+    totalLength = 0;
+}
+
+/**
+ * Updates the position index of the ids in positions [first, last]
+ * Time Complexity: O(last - first)
+ */
+void Tour::reposition(unsigned int first, unsigned int last) {
+    for (unsigned int i = first; i <= last; i++) position[order[i]] = i;
+}
+
+/**
+ * Reverses count consecutive positions of the cycle, from first to last, wrapping around the end of the array
+ * Time Complexity: O(count)
+ */
+void Tour::reverseCyclic(unsigned int first, unsigned int last, unsigned int count) {
+    unsigned int n = size();
+    for (unsigned int t = 0; t < count / 2; t++) {
+        std::swap(order[first], order[last]);
+        position[order[first]] = first;
+        position[order[last]] = last;
+        first = first + 1 == n ? 0 : first + 1;
+        last = last == 0 ? n - 1 : last - 1;
+    }
+}
+
+/**
+ * Adds a vertex after the last one
+ * Time Complexity: O(1) (amortized)
+ * @param id - Vertex to add
+ * @param edgeLength - Length of the edge from the previous last vertex (added to the cached length)
+ */
+void Tour::append(unsigned int id, double edgeLength) {
+    if (id >= position.size()) position.resize(id + 1, NOT_IN_TOUR);
+    position[id] = size();
+    order.push_back(id);
+    totalLength += edgeLength;
+}
+
+/**
+ * Inserts a vertex so that it ends up at a given position, shifting the following ones
+ * Time Complexity: O(n - at)
+ * @param at - Position of the new vertex (size() to append it)
+ * @param id - Vertex to insert
+ * @param delta - Change in the length of the tour (added to the cached length)
+ */
+void Tour::insert(unsigned int at, unsigned int id, double delta) {
+    if (id >= position.size()) position.resize(id + 1, NOT_IN_TOUR);
+    order.insert(order.begin() + at, id);
+    reposition(at, size() - 1);
+    totalLength += delta;
+}
+
+/**
+ * Removes the vertex at a given position, shifting the following ones
+ * Time Complexity: O(n - i)
+ * @param i - Position of the vertex to remove
+ * @param delta - Change in the length of the tour (added to the cached length)
+ */
+void Tour::remove(unsigned int i, double delta) {
+    position[order[i]] = NOT_IN_TOUR;
+    order.erase(order.begin() + i);
+    if (i < size()) reposition(i, size() - 1);
+    totalLength += delta;
+}
+
+unsigned int Tour::size() const {
+    return (unsigned int) order.size();
+}
+
+bool Tour::empty() const {
+    return order.empty();
+}
+
+/**
+ * @return Id of the vertex at position i
+ */
+unsigned int Tour::operator[](unsigned int i) const {
+    return order[i];
+}
+
+/**
+ * @return Position that follows position i, wrapping back to the start
+ */
+unsigned int Tour::next(unsigned int i) const {
+    return i + 1 == size() ? 0 : i + 1;
+}
+
+/**
+ * @return Position that precedes position i, wrapping back to the end
+ */
+unsigned int Tour::previous(unsigned int i) const {
+    return i == 0 ? size() - 1 : i - 1;
+}
+
+bool Tour::contains(unsigned int id) const {
+    return id < position.size() && position[id] != NOT_IN_TOUR;
+}
+
+/**
+ * Time Complexity: O(1)
+ * @return Position of a vertex in the tour (the vertex must be in it)
+ */
+unsigned int Tour::positionOf(unsigned int id) const {
+    return position[id];
+}
+
+/**
+ * @return Ids in visiting order, without repeating the first one at the end
+ */
+std::span<const unsigned int> Tour::getIds() const {
+    return order;
+}
+
+std::vector<unsigned int>::const_iterator Tour::begin() const {
+    return order.begin();
+}
+
+std::vector<unsigned int>::const_iterator Tour::end() const {
+    return order.end();
+}
+
+/**
+ * @return Length of the closed tour (infinite if some edge doesn't exist)
+ */
+double Tour::getLength() const {
+    return totalLength;
+}
+
+void Tour::setLength(double newLength) {
+    totalLength = newLength;
+}
+
+/**
+ * Applies a 2-opt move: reverses the segment between positions i and j
+ * The shorter of the segment and its complement is reversed, which gives the same cycle
+ * Time Complexity: O(min(j - i, n - (j - i)))
+ * @param i - First position of the segment
+ * @param j - Last position of the segment (i <= j)
+ * @param delta - Change in length, as given by twoOptDelta (added to the cached length)
+ */
+void Tour::twoOpt(unsigned int i, unsigned int j, double delta) {
+    unsigned int inner = j - i + 1, n = size();
+    if (inner * 2 <= n) reverseCyclic(i, j, inner);
+    else reverseCyclic(next(j), previous(i), n - inner);
+    totalLength += delta;
+}
+
+/**
+ * Applies an or-opt move: cuts the segment between positions i and j and reinserts it after position k
+ * Time Complexity: O(|k - i|)
+ * @param i - First position of the segment
+ * @param j - Last position of the segment (i <= j)
+ * @param k - Position after which the segment is reinserted (neither in [i, j] nor the one before i)
+ * @param reversed - Whether the segment is reinserted backwards
+ * @param delta - Change in length, as given by orOptDelta (added to the cached length)
+ */
+void Tour::orOpt(unsigned int i, unsigned int j, unsigned int k, bool reversed, double delta) {
+    unsigned int first, last;
+    if (k > j) {
+        std::rotate(order.begin() + i, order.begin() + j + 1, order.begin() + k + 1);
+        first = i;
+        last = k;
+        if (reversed) std::reverse(order.begin() + k - (j - i), order.begin() + k + 1);
+    } else {
+        std::rotate(order.begin() + k + 1, order.begin() + i, order.begin() + j + 1);
+        first = k + 1;
+        last = j;
+        if (reversed) std::reverse(order.begin() + k + 1, order.begin() + k + 2 + (j - i));
+    }
+    reposition(first, last);
+    totalLength += delta;
+}
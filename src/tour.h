@@ -0,0 +1,122 @@
+#ifndef TRAVELLINGSALESMAN_TOUR_H
+#define TRAVELLINGSALESMAN_TOUR_H
+
+#include <vector>
+#include <span>
+#include <utility>
+#include "constants.h"
+
+/**
+ * Closed route through a set of vertices, stored as the array of their dense ids in visiting order
+ * (the return to the first vertex is implicit) plus the inverse array holding the position of every id
+ * The length is cached and kept up to date by the moves, whose change in length is computed in O(1) from the
+ * edges they replace, so local search never has to walk the whole tour
+ * Lengths are read through a callable length(a, b), so the same tour works with any edge source;
+ * edges are assumed to be undirected
+ */
+class Tour {
+  private:
+    static constexpr unsigned int NOT_IN_TOUR = constants::NO_VERTEX;
+
+    std::vector<unsigned int> order;    // ids in visiting order
+    std::vector<unsigned int> position; // position of each id in order, or NOT_IN_TOUR
+    double totalLength = 0;
+
+    void reposition(unsigned int first, unsigned int last);
+
+    void reverseCyclic(unsigned int first, unsigned int last, unsigned int count);
+
+  public:
+    explicit Tour(unsigned int vertexCount = 0);
+
+    void reserve(unsigned int vertexCount);
+
+    void clear();
+
+    void append(unsigned int id, double edgeLength);
+
+    void insert(unsigned int at, unsigned int id, double delta);
+
+    void remove(unsigned int i, double delta);
+
+    [[nodiscard]] unsigned int size() const;
+
+    [[nodiscard]] bool empty() const;
+
+    [[nodiscard]] unsigned int operator[](unsigned int i) const;
+
+    [[nodiscard]] unsigned int next(unsigned int i) const;
+
+    [[nodiscard]] unsigned int previous(unsigned int i) const;
+
+    [[nodiscard]] bool contains(unsigned int id) const;
+
+    [[nodiscard]] unsigned int positionOf(unsigned int id) const;
+
+    [[nodiscard]] std::span<const unsigned int> getIds() const;
+
+    [[nodiscard]] std::vector<unsigned int>::const_iterator begin() const;
+
+    [[nodiscard]] std::vector<unsigned int>::const_iterator end() const;
+
+    [[nodiscard]] double getLength() const;
+
+    void setLength(double newLength);
+
+    void twoOpt(unsigned int i, unsigned int j, double delta);
+
+    void orOpt(unsigned int i, unsigned int j, unsigned int k, bool reversed, double delta);
+
+    /**
+     * Change in length of twoOpt(i, j): the edges entering position i and leaving position j are replaced by
+     * the edges (entering i, j) and (i, leaving j)
+     * Time Complexity: O(1)
+     * @param i - First position of the segment to reverse
+     * @param j - Last position of the segment to reverse (i <= j)
+     * @param length - Callable returning the length of the edge between two ids
+     */
+    template<typename Length>
+    [[nodiscard]] double twoOptDelta(unsigned int i, unsigned int j, Length &&length) const {
+        unsigned int a = order[previous(i)], b = order[i], c = order[j], d = order[next(j)];
+        if (a == c || b == d) return 0; //The segment or its complement is the whole tour, so nothing changes
+        return length(a, c) + length(b, d) - length(a, b) - length(c, d);
+    }
+
+    /**
+     * Change in length of orOpt(i, j, k, reversed): the segment [i, j] is cut out and reinserted between the
+     * vertices at positions k and k + 1
+     * Time Complexity: O(1)
+     * @param i - First position of the segment
+     * @param j - Last position of the segment (i <= j)
+     * @param k - Position after which the segment is reinserted (neither in [i, j] nor the one before i)
+     * @param reversed - Whether the segment is reinserted backwards
+     * @param length - Callable returning the length of the edge between two ids
+     */
+    template<typename Length>
+    [[nodiscard]] double orOptDelta(unsigned int i, unsigned int j, unsigned int k, bool reversed,
+                                    Length &&length) const {
+        unsigned int before = order[previous(i)], first = order[i], last = order[j], after = order[next(j)];
+        unsigned int left = order[k], right = order[next(k)];
+        if (reversed) std::swap(first, last);
+        return length(before, after) + length(left, first) + length(last, right)
+               - length(before, order[i]) - length(order[j], after) - length(left, right);
+    }
+
+    /**
+     * Recomputes the length of the whole tour, including the edge back to the first vertex
+     * Time Complexity: O(n)
+     * @param length - Callable returning the length of the edge between two ids
+     * @return The recomputed length (also cached)
+     */
+    template<typename Length>
+    double computeLength(Length &&length) {
+        double total = 0;
+        for (unsigned int i = 0; i + 1 < size(); i++) total += length(order[i], order[i + 1]);
+        if (size() > 1) total += length(order.back(), order.front());
+        totalLength = total;
+        return total;
+    }
+};
+
+
+#endif //TRAVELLINGSALESMAN_TOUR_H
@@ -0,0 +1,61 @@
+#include "tourArena.h"
+#include <algorithm>
+
+/**
+ * @param tours - Number of tours
+ * @param vertexCount - Number of vertices in every tour
+ */
+TourArena::TourArena(unsigned int tours, unsigned int vertexCount)
+        : vertexCount(vertexCount), ids((size_t) tours * vertexCount), lengths(tours, constants::INF) {}
+
+unsigned int TourArena::size() const {
+    return (unsigned int) lengths.size();
+}
+
+/**
+ * @return Ids of tour t in visiting order
+ */
+std::span<unsigned int> TourArena::operator[](unsigned int t) {
+    return {ids.data() + (size_t) t * vertexCount, vertexCount};
+}
+
+std::span<const unsigned int> TourArena::operator[](unsigned int t) const {
+    return {ids.data() + (size_t) t * vertexCount, vertexCount};
+}
+
+double TourArena::getLength(unsigned int t) const {
+    return lengths[t];
+}
+
+/**
+ * Overwrites tour t with a copy of a tour
+ * Time Complexity: O(n)
+ * @param t - Tour to overwrite
+ * @param tour - Tour visiting every vertex
+ */
+void TourArena::store(unsigned int t, const Tour &tour) {
+    std::copy(tour.begin(), tour.end(), (*this)[t].begin());
+    lengths[t] = tour.getLength();
+}
+
+/**
+ * Overwrites a tour with a copy of another one
+ * Time Complexity: O(n)
+ */
+void TourArena::copy(unsigned int from, unsigned int to) {
+    std::copy_n(ids.begin() + (long) ((size_t) from * vertexCount), vertexCount,
+                ids.begin() + (long) ((size_t) to * vertexCount));
+    lengths[to] = lengths[from];
+}
+
+/**
+ * Replaces the contents of a Tour with tour t, so it can be changed with the moves of Tour
+ * Time Complexity: O(n)
+ * @param t - Tour to read
+ * @param tour - Tour that receives it (its memory is reused)
+ */
+void TourArena::load(unsigned int t, Tour &tour) const {
+    tour.clear();
+    for (unsigned int id: (*this)[t]) tour.append(id, 0);
+    tour.setLength(lengths[t]);
+}
@@ -0,0 +1,37 @@
+#ifndef TRAVELLINGSALESMAN_TOURARENA_H
+#define TRAVELLINGSALESMAN_TOURARENA_H
+
+#include <vector>
+#include <span>
+#include "tour.h"
+
+/**
+ * Fixed number of tours over the same vertices, stored back to back in one array, with their lengths
+ * A population kept this way is a single allocation, and replacing or copying a tour never allocates
+ */
+class TourArena {
+  private:
+    unsigned int vertexCount;
+    std::vector<unsigned int> ids; // tour t is at [t * vertexCount, (t + 1) * vertexCount)
+    std::vector<double> lengths;
+
+  public:
+    TourArena(unsigned int tours, unsigned int vertexCount);
+
+    [[nodiscard]] unsigned int size() const;
+
+    [[nodiscard]] std::span<unsigned int> operator[](unsigned int t);
+
+    [[nodiscard]] std::span<const unsigned int> operator[](unsigned int t) const;
+
+    [[nodiscard]] double getLength(unsigned int t) const;
+
+    void store(unsigned int t, const Tour &tour);
+
+    void copy(unsigned int from, unsigned int to);
+
+    void load(unsigned int t, Tour &tour) const;
+};
+
+
+#endif //TRAVELLINGSALESMAN_TOURARENA_H
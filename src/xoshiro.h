@@ -0,0 +1,81 @@
+#ifndef TRAVELLINGSALESMAN_XOSHIRO_H
+#define TRAVELLINGSALESMAN_XOSHIRO_H
+
+#include <cstdint>
+#include <limits>
+#include <random>
+
+/**
+ * xoshiro256** pseudo-random generator: 32 bytes of state and a few shifts and rotations per number, so it is cheap
+ * enough to call on every move of a local search
+ * Satisfies UniformRandomBitGenerator, so it also works with the standard distributions
+ * Not thread-safe: each thread uses its own generator (see local)
+ */
+class Xoshiro256 {
+  private:
+    uint64_t state[4];
+
+    static uint64_t rotate(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+  public:
+    using result_type = uint64_t;
+
+    /**
+     * @param seed - Any value; the state is spread from it with splitmix64, so close seeds give unrelated streams
+     */
+    explicit Xoshiro256(uint64_t seed = 0) {
+        for (uint64_t &s: state) {
+            uint64_t z = (seed += 0x9e3779b97f4a7c15);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+            s = z ^ (z >> 31);
+        }
+    }
+
+    static constexpr result_type min() {
+        return 0;
+    }
+
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()() {
+        uint64_t result = rotate(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotate(state[3], 45);
+        return result;
+    }
+
+    /**
+     * @return Uniform double in [0, 1)
+     */
+    double uniform() {
+        return (double) ((*this)() >> 11) * 0x1.0p-53;
+    }
+
+    /**
+     * Uniform integer in [0, bound), by multiplying instead of dividing (the bias is below 2^-32 for any bound)
+     * @param bound - Number of possible values (at least 1)
+     */
+    unsigned int below(unsigned int bound) {
+        return (unsigned int) (((*this)() >> 32) * bound >> 32);
+    }
+
+    /**
+     * @return Generator of the calling thread, seeded once per thread from std::random_device
+     */
+    static Xoshiro256 &local() {
+        thread_local Xoshiro256 generator(((uint64_t) std::random_device()() << 32) ^ std::random_device()());
+        return generator;
+    }
+};
+
+#endif //TRAVELLINGSALESMAN_XOSHIRO_H